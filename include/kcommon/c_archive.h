@@ -0,0 +1,661 @@
+/*
+        binary serialization over streams
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include "c_string.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define KCOMMON_BIG_ENDIAN 1
+#endif
+
+
+// geometry types are only declared here, so archive doesn't depend on geometry
+namespace c_geometry
+{
+    template <typename T> struct vec2;
+    template <typename T> struct vec3;
+    template <typename T> struct vec4;
+    template <typename T> struct mat2x2;
+    template <typename T> struct mat3x2;
+    template <typename T> struct mat3x3;
+    template <typename T> struct mat4x4;
+}
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     archive format
+     -------------------------------------------------------------------------------
+         archive is a plain sequence of values without any type information,
+         reader must read values in the same order they were written
+
+            varint           - LEB128 unsigned integer (7 bits per byte, high
+                               bit set means more bytes follow), signed values
+                               are zigzag encoded first
+            value            - fixed size little endian value
+            items            - array elements as is (little endian), items are
+                               padded with zeroes to min(alignof(V), 8) from
+                               archive start, so arrays could be viewed in
+                               place from aligned memory
+            array, string    - varint element count followed by items
+
+         fixed size values are arithmetic types and types which have
+         ArchiveScalar specialization: struct which consists only of
+         scalar components of the same type (vectors, matrices, points,
+         rects), ArchiveScalar<V>::type is the component type used for
+         byte order conversion
+
+         archive position (offset()) is counted from archive object creation,
+         not from stream start
+    */
+
+    template <typename T>
+    struct ArchiveScalar
+    {
+        using type = std::conditional_t<std::is_arithmetic_v<T>, T, void>;
+    };
+
+    template <typename T> struct ArchiveScalar<c_geometry::vec2<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::vec3<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::vec4<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::mat2x2<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::mat3x2<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::mat3x3<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_geometry::mat4x4<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_util::pointT<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_util::sizeT<T>> { using type = T; };
+    template <typename T> struct ArchiveScalar<c_util::rectT<T>> { using type = T; };
+
+
+    // archive helpers
+    struct ArchiveUtil
+    {
+        enum {
+            MAX_VARINT = 10,  // max encoded size of 64 bit varint
+            MAX_ALIGN  = 8
+        };
+
+        template <typename V>
+        static void check()
+        {
+            using S = typename ArchiveScalar<V>::type;
+            static_assert(!std::is_void_v<S>, "type has no ArchiveScalar specialization");
+            static_assert(std::is_trivially_copyable_v<V>, "archive value must be trivially copyable");
+            static_assert(sizeof(V) % sizeof(S) == 0, "archive value must consist of scalar components");
+        }
+
+        // true if items could be read/written as is
+        template <typename V>
+        static constexpr bool native()
+        {
+#if KCOMMON_BIG_ENDIAN
+            return sizeof(typename ArchiveScalar<V>::type) == 1;
+#else
+            return true;
+#endif
+        }
+
+        // converts items between host and archive byte order
+        template <typename V>
+        static void convert(void *items, size_t count)
+        {
+            if constexpr (!native<V>()) {
+                auto scalar = sizeof(typename ArchiveScalar<V>::type);
+                auto data = static_cast<unsigned char*>(items);
+                auto end = data + count * sizeof(V);
+                for (; data < end; data += scalar) {
+                    for (auto a = size_t(0), b = scalar - 1; a < b; ++a, --b) {
+                        auto t = data[a];
+                        data[a] = data[b];
+                        data[b] = t;
+                    }
+                }
+            }
+        }
+
+        template <typename V>
+        static size_t padding(size_t offset)
+        {
+            auto align = c_util::umin(alignof(V), size_t(MAX_ALIGN));
+            return (align - offset % align) % align;
+        }
+
+        static uint64_t zigzag(int64_t value)
+        {
+            return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+        }
+
+        static int64_t unzigzag(uint64_t value)
+        {
+            return int64_t(value >> 1) ^ -int64_t(value & 1);
+        }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArchiveWriter
+     -------------------------------------------------------------------------------
+         writes archive to any streamT<size_t>
+
+         every Write call is one or two stream writes, so unbuffered
+         destination should be wrapped in BufferedWriter, WriteItems()
+         writes whole array with single write
+
+         first failed write puts writer into failed state, all following
+         writes are ignored
+    */
+
+    class ArchiveWriter
+    {
+    public:
+        ArchiveWriter(streamT<size_t> &destination) :
+            p_destination(destination),
+            p_offset(0),
+            p_failed(false)
+        {}
+
+        streamT<size_t> &destination() const { return p_destination; }
+
+        bool failed() const { return p_failed; }
+        size_t offset() const { return p_offset; }
+
+        bool WriteVarUInt(uint64_t value)
+        {
+            unsigned char buffer[ArchiveUtil::MAX_VARINT];
+            auto length = size_t(0);
+
+            while (value >= 0x80) {
+                buffer[length++] = uint8_t(value | 0x80);
+                value >>= 7;
+            }
+            buffer[length++] = uint8_t(value);
+
+            return Put(buffer, length);
+        }
+
+        bool WriteVarInt(int64_t value)
+        {
+            return WriteVarUInt(ArchiveUtil::zigzag(value));
+        }
+
+        template <typename V>
+        bool WriteValue(const V &value)
+        {
+            ArchiveUtil::check<V>();
+
+            if constexpr (ArchiveUtil::native<V>()) {
+                return Put(&value, sizeof(V));
+            } else {
+                unsigned char buffer[sizeof(V)];
+                memcpy(buffer, &value, sizeof(V));
+                ArchiveUtil::convert<V>(buffer, 1);
+                return Put(buffer, sizeof(V));
+            }
+        }
+
+        // writes items without count
+        template <typename V, typename M>
+        bool WriteItems(const Span<V, M> &items)
+        {
+            ArchiveUtil::check<V>();
+
+            static const unsigned char zeroes[ArchiveUtil::MAX_ALIGN] = {};
+            if (!Put(zeroes, ArchiveUtil::padding<V>(p_offset))) {
+                return false;
+            }
+
+            if constexpr (ArchiveUtil::native<V>()) {
+                return Put(items.data(), items.size() * sizeof(V));
+            } else {
+                // convert through small buffer, source isn't modified
+                unsigned char buffer[4096];
+                auto perchunk = c_util::umax(sizeof(buffer) / sizeof(V), size_t(1));
+                for (auto n = size_t(0); n < items.size(); n += perchunk) {
+                    auto count = c_util::umin(perchunk, items.size() - n);
+                    if (count * sizeof(V) > sizeof(buffer)) {
+                        // single value larger than buffer
+                        V value = items.data()[n];
+                        ArchiveUtil::convert<V>(&value, 1);
+                        if (!Put(&value, sizeof(V))) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    memcpy(buffer, items.data() + n, count * sizeof(V));
+                    ArchiveUtil::convert<V>(buffer, count);
+                    if (!Put(buffer, count * sizeof(V))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        template <typename V, typename M>
+        bool WriteArray(const Span<V, M> &items)
+        {
+            return WriteVarUInt(items.size()) && WriteItems(items);
+        }
+
+        template <typename T, typename M>
+        bool WriteString(const StringViewBase<T, M> &text)
+        {
+            return WriteArray(Span<T>(text.data(), text.size()));
+        }
+
+        bool WriteBytes(const Span<unsigned char> &bytes)
+        {
+            return WriteArray(bytes);
+        }
+
+    private:
+        bool Put(const void *data, size_t size)
+        {
+            if (p_failed) {
+                return false;
+            }
+
+            if (size == 0) {
+                return true;
+            }
+
+            auto written = p_destination.write(data, size);
+            p_offset += written;
+            p_failed = written != size;
+
+            return !p_failed;
+        }
+
+    private:
+        streamT<size_t> &p_destination;
+        size_t           p_offset;
+        bool             p_failed;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArchiveReader
+     -------------------------------------------------------------------------------
+         reads archive from any streamT<size_t>, all data is copied
+
+         varints are read byte by byte, unbuffered source should be wrapped
+         in BufferedReader
+
+         for sources with known size (Read, ReadWrite modes) array and string
+         counts are checked against remaining stream size before allocation
+
+         first failed read puts reader into failed state, all following
+         reads fail
+    */
+
+    class ArchiveReader
+    {
+    public:
+        ArchiveReader(streamT<size_t> &source) :
+            p_source(source),
+            p_offset(0),
+            p_failed(false)
+        {}
+
+        streamT<size_t> &source() const { return p_source; }
+
+        bool failed() const { return p_failed; }
+        size_t offset() const { return p_offset; }
+
+        bool ReadVarUInt(uint64_t &value)
+        {
+            value = 0;
+            for (auto n = 0; n < ArchiveUtil::MAX_VARINT; ++n) {
+                unsigned char byte;
+                if (!Get(&byte, 1)) {
+                    return false;
+                }
+
+                value |= uint64_t(byte & 0x7F) << (n * 7);
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+
+            return Fail();
+        }
+
+        bool ReadVarInt(int64_t &value)
+        {
+            uint64_t encoded;
+            if (!ReadVarUInt(encoded)) {
+                return false;
+            }
+
+            value = ArchiveUtil::unzigzag(encoded);
+            return true;
+        }
+
+        template <typename V>
+        bool ReadValue(V &value)
+        {
+            ArchiveUtil::check<V>();
+
+            if (!Get(&value, sizeof(V))) {
+                return false;
+            }
+
+            ArchiveUtil::convert<V>(&value, 1);
+            return true;
+        }
+
+        // reads array or string element count, count of items of size
+        // itemsize should fit into remaining data
+        bool ReadCount(size_t &count, size_t itemsize = 1)
+        {
+            uint64_t value;
+            if (!ReadVarUInt(value)) {
+                return false;
+            }
+
+            if (value > std::numeric_limits<size_t>::max() / c_util::umax(itemsize, size_t(1))) {
+                return Fail();
+            }
+
+            auto m = p_source.mode();
+            if ((m == StreamMode::Read || m == StreamMode::ReadWrite) &&
+                value * itemsize > p_source.size() - p_source.position()) {
+                return Fail();
+            }
+
+            count = size_t(value);
+            return true;
+        }
+
+        // reads items without count, whole span is filled
+        template <typename V>
+        bool ReadItems(const MutableSpan<V> &items)
+        {
+            ArchiveUtil::check<V>();
+
+            if (!Skip(ArchiveUtil::padding<V>(p_offset)) || !Get(items.data(), items.size() * sizeof(V))) {
+                return false;
+            }
+
+            ArchiveUtil::convert<V>(items.data(), items.size());
+            return true;
+        }
+
+        template <typename T, typename N, typename A>
+        bool ReadString(StringBase<T, N, A> &text)
+        {
+            size_t count;
+            if (!ReadCount(count, sizeof(T))) {
+                return false;
+            }
+
+            if (count == 0) {
+                text = StringBase<T, N, A>();
+                return true;
+            }
+
+            auto data = A::Allocate(count + N::NULL_LEN);
+            if (!ReadItems(MutableSpan<T>(data, count))) {
+                A::Free(data);
+                return false;
+            }
+
+            text = StringBase<T, N, A>::Adopt(data, count);
+
+            return true;
+        }
+
+        bool Skip(size_t size)
+        {
+            unsigned char buffer[256];
+            while (size > 0) {
+                auto amount = c_util::umin(size, sizeof(buffer));
+                if (!Get(buffer, amount)) {
+                    return false;
+                }
+                size -= amount;
+            }
+
+            return true;
+        }
+
+    private:
+        bool Fail()
+        {
+            p_failed = true;
+            return false;
+        }
+
+        bool Get(void *data, size_t size)
+        {
+            if (p_failed) {
+                return false;
+            }
+
+            if (size == 0) {
+                return true;
+            }
+
+            // source could return less before its end (like pipe does)
+            auto dest = static_cast<unsigned char*>(data);
+            auto total = size_t(0);
+            while (total < size) {
+                auto amount = p_source.read(dest + total, size - total);
+                if (amount == 0) {
+                    break;
+                }
+                total += amount;
+            }
+            p_offset += total;
+
+            return total == size || Fail();
+        }
+
+    private:
+        streamT<size_t> &p_source;
+        size_t           p_offset;
+        bool             p_failed;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArchiveView
+     -------------------------------------------------------------------------------
+         zero copy archive reader over memory block
+
+         memory block usually comes from MemoryStream::data() or
+         MappedFileStream::data(), View functions return spans and string
+         views pointing directly into that memory, so memory must stay
+         valid while they are in use
+
+         ViewItems() works only for items which don't need byte order
+         conversion (any item on little endian host) and only if archive
+         start is aligned to 8 bytes (which is true for mapped files and
+         heap blocks), otherwise it fails and ReadItems() should be used
+
+         first failed read puts view into failed state, all following
+         reads fail
+    */
+
+    class ArchiveView
+    {
+    public:
+        ArchiveView(const Span<unsigned char> &data) :
+            p_data(data),
+            p_offset(0),
+            p_failed(false)
+        {}
+
+        bool failed() const { return p_failed; }
+        size_t offset() const { return p_offset; }
+        size_t remaining() const { return p_data.size() - p_offset; }
+
+        bool ReadVarUInt(uint64_t &value)
+        {
+            if (p_failed) {
+                return false;
+            }
+
+            value = 0;
+
+            auto current = p_data.data() + p_offset;
+            auto end = current + c_util::umin(remaining(), size_t(ArchiveUtil::MAX_VARINT));
+
+            for (auto shift = 0; current < end; shift += 7) {
+                auto byte = *current++;
+                value |= uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    p_offset = size_t(current - p_data.data());
+                    return true;
+                }
+            }
+
+            return Fail();
+        }
+
+        bool ReadVarInt(int64_t &value)
+        {
+            uint64_t encoded;
+            if (!ReadVarUInt(encoded)) {
+                return false;
+            }
+
+            value = ArchiveUtil::unzigzag(encoded);
+            return true;
+        }
+
+        template <typename V>
+        bool ReadValue(V &value)
+        {
+            ArchiveUtil::check<V>();
+
+            if (p_failed || remaining() < sizeof(V)) {
+                return Fail();
+            }
+
+            memcpy(&value, p_data.data() + p_offset, sizeof(V));
+            p_offset += sizeof(V);
+
+            ArchiveUtil::convert<V>(&value, 1);
+            return true;
+        }
+
+        bool ReadCount(size_t &count, size_t itemsize = 1)
+        {
+            uint64_t value;
+            if (!ReadVarUInt(value)) {
+                return false;
+            }
+
+            if (value > remaining() / c_util::umax(itemsize, size_t(1))) {
+                return Fail();
+            }
+
+            count = size_t(value);
+            return true;
+        }
+
+        // copies items, whole span is filled
+        template <typename V>
+        bool ReadItems(const MutableSpan<V> &items)
+        {
+            const unsigned char *source;
+            if (!Items<V>(items.size(), source)) {
+                return false;
+            }
+
+            memcpy(items.data(), source, items.size() * sizeof(V));
+            ArchiveUtil::convert<V>(items.data(), items.size());
+
+            return true;
+        }
+
+        // returns count items in place
+        template <typename V>
+        bool ViewItems(size_t count, Span<V> &items)
+        {
+            if constexpr (!ArchiveUtil::native<V>()) {
+                return Fail();
+            }
+
+            const unsigned char *source;
+            if (!Items<V>(count, source) || reinterpret_cast<uintptr_t>(source) % alignof(V) != 0) {
+                return Fail();
+            }
+
+            items = Span<V>(reinterpret_cast<const V*>(source), count);
+            return true;
+        }
+
+        template <typename V>
+        bool ViewArray(Span<V> &items)
+        {
+            size_t count;
+            return ReadCount(count, sizeof(V)) && ViewItems(count, items);
+        }
+
+        template <typename T>
+        bool ViewString(StringViewBase<T> &text)
+        {
+            Span<T> items;
+            if (!ViewArray(items)) {
+                return false;
+            }
+
+            text = StringViewBase<T>(items.data(), items.size());
+            return true;
+        }
+
+        bool ViewBytes(Span<unsigned char> &bytes)
+        {
+            return ViewArray(bytes);
+        }
+
+    private:
+        bool Fail()
+        {
+            p_failed = true;
+            return false;
+        }
+
+        // skips padding and count items, gives pointer to first item
+        template <typename V>
+        bool Items(size_t count, const unsigned char *&items)
+        {
+            ArchiveUtil::check<V>();
+
+            auto padding = ArchiveUtil::padding<V>(p_offset);
+            if (p_failed || remaining() < padding || (remaining() - padding) / sizeof(V) < count) {
+                return Fail();
+            }
+
+            items = p_data.data() + p_offset + padding;
+            p_offset += padding + count * sizeof(V);
+
+            return true;
+        }
+
+    private:
+        Span<unsigned char> p_data;
+        size_t              p_offset;
+        bool                p_failed;
+    };
+}
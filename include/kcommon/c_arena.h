@@ -0,0 +1,447 @@
+/*
+        arena (monotonic bump) allocator
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_util.h"
+#include "c_span.h"
+#include "c_stringview.h"
+#include "c_string.h"
+#include "c_stringbuilder.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     Arena
+     -------------------------------------------------------------------------------
+         monotonic allocator, memory is taken from large chunks by moving
+         chunk pointer forward, individual allocations are never freed,
+         instead whole arena is reset or rewound to previously taken marker
+         with O(1) cost per chunk
+
+            auto mark = arena.marker();
+            auto items = arena.AllocateSpan<Item>(count);
+            ...
+            arena.Rewind(mark); // items are gone
+
+         allocations which don't fit into standard chunk (larger than quarter
+         of chunk size) get dedicated chunk, standard chunks released by
+         Rewind() or Reset() are kept for reuse until Release() is called
+
+         arena doesn't call destructors, only trivially destructible types
+         could be placed into it
+
+         arena isn't thread safe, current() gives arena set by ArenaScope on
+         calling thread, it's used by ArenaStringAllocator
+    */
+
+    class Arena
+    {
+    private:
+        struct Chunk
+        {
+            Chunk  *next;
+            size_t  size;  // size of data following header
+            size_t  used;
+        };
+
+    public:
+        enum : size_t
+        {
+            DEFAULT_CHUNK_SIZE = 64 * 1024,
+            DEFAULT_ALIGNMENT  = alignof(std::max_align_t)
+        };
+
+        // allocation state, see marker() and Rewind()
+        struct Marker
+        {
+            Chunk  *chunk = nullptr;
+            size_t  used = 0;
+        };
+
+    public:
+        Arena(size_t chunksize = DEFAULT_CHUNK_SIZE) noexcept :
+            p_chunksize(c_util::umax(chunksize, size_t(1024))),
+            p_current(nullptr),
+            p_spare(nullptr),
+            p_allocated(0)
+        {}
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena()
+        {
+            Release();
+        }
+
+        // allocates size bytes aligned to alignment (power of 2)
+        void *Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT)
+        {
+            if (p_current) {
+                auto result = Place(p_current, size, alignment);
+                if (result) {
+                    return result;
+                }
+            }
+
+            // worst case padding is alignment - 1
+            auto required = size + alignment - 1;
+
+            Chunk *chunk;
+            if (required > p_chunksize / 4) {
+                chunk = NewChunk(c_util::umax(required, p_chunksize));
+            } else if (p_spare) {
+                chunk = p_spare;
+                p_spare = chunk->next;
+            } else {
+                chunk = NewChunk(p_chunksize);
+            }
+
+            chunk->used = 0;
+            chunk->next = p_current;
+            p_current = chunk;
+
+            return Place(chunk, size, alignment);
+        }
+
+        // allocates default constructed array
+        template <typename T>
+        T *AllocateArray(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "arena doesn't call destructors");
+
+            auto result = static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+            for (auto n = size_t(0); n < count; ++n) {
+                new (result + n) T();
+            }
+
+            return result;
+        }
+
+        template <typename T>
+        MutableSpan<T> AllocateSpan(size_t count)
+        {
+            return MutableSpan<T>(AllocateArray<T>(count), count);
+        }
+
+        // copies items into arena
+        template <typename T, typename M>
+        MutableSpan<T> CopySpan(const Span<T, M> &source)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable items could be copied");
+
+            auto result = static_cast<T*>(Allocate(source.size() * sizeof(T), alignof(T)));
+            memcpy(result, source.data(), source.size() * sizeof(T));
+
+            return MutableSpan<T>(result, source.size());
+        }
+
+        // copies text into arena, copy is null terminated
+        template <typename T, typename M>
+        StringViewBase<T> CopyString(const StringViewBase<T, M> &source)
+        {
+            auto result = static_cast<T*>(Allocate((source.size() + 1) * sizeof(T), alignof(T)));
+            memcpy(result, source.data(), source.size() * sizeof(T));
+            result[source.size()] = T(0);
+
+            return StringViewBase<T>(result, source.size());
+        }
+
+        // current allocation state
+        Marker marker() const noexcept
+        {
+            Marker result;
+            if (p_current) {
+                result.chunk = p_current;
+                result.used = p_current->used;
+            }
+            return result;
+        }
+
+        // frees everything allocated after marker was taken
+        void Rewind(const Marker &marker) noexcept
+        {
+            while (p_current != marker.chunk) {
+                auto chunk = p_current;
+                p_current = chunk->next;
+                Free(chunk);
+            }
+
+            if (p_current) {
+                p_current->used = marker.used;
+            }
+        }
+
+        // frees all allocations, standard chunks are kept for reuse
+        void Reset() noexcept
+        {
+            Rewind(Marker());
+        }
+
+        // frees all allocations and gives memory back to the system
+        void Release() noexcept
+        {
+            Reset();
+
+            while (p_spare) {
+                auto chunk = p_spare;
+                p_spare = chunk->next;
+                DeleteChunk(chunk);
+            }
+        }
+
+        size_t chunksize() const noexcept { return p_chunksize; }
+
+        // memory held by arena including spare chunks
+        size_t allocated() const noexcept { return p_allocated; }
+
+        // memory taken by allocations including alignment padding
+        size_t used() const noexcept
+        {
+            auto result = size_t(0);
+            for (auto chunk = p_current; chunk; chunk = chunk->next) {
+                result += chunk->used;
+            }
+            return result;
+        }
+
+        // arena set by innermost ArenaScope on calling thread, or nullptr
+        static Arena *current() noexcept { return currentslot(); }
+
+    private:
+        friend class ArenaScope;
+
+        static Arena *&currentslot() noexcept
+        {
+            static thread_local Arena *arena = nullptr;
+            return arena;
+        }
+
+        static unsigned char *data(Chunk *chunk) noexcept
+        {
+            return reinterpret_cast<unsigned char*>(chunk + 1);
+        }
+
+        // returns nullptr if allocation doesn't fit into chunk
+        static void *Place(Chunk *chunk, size_t size, size_t alignment) noexcept
+        {
+            auto base = reinterpret_cast<uintptr_t>(data(chunk));
+            auto offset = size_t(c_util::align(base + chunk->used, uintptr_t(alignment)) - base);
+
+            if (offset > chunk->size || size > chunk->size - offset) {
+                return nullptr;
+            }
+
+            chunk->used = offset + size;
+            return data(chunk) + offset;
+        }
+
+        Chunk *NewChunk(size_t size)
+        {
+            auto chunk = reinterpret_cast<Chunk*>(new unsigned char[sizeof(Chunk) + size]);
+            chunk->next = nullptr;
+            chunk->size = size;
+            chunk->used = 0;
+
+            p_allocated += sizeof(Chunk) + size;
+            return chunk;
+        }
+
+        void DeleteChunk(Chunk *chunk) noexcept
+        {
+            p_allocated -= sizeof(Chunk) + chunk->size;
+            delete[] reinterpret_cast<unsigned char*>(chunk);
+        }
+
+        // dedicated chunks are deleted, standard ones go to spare list
+        void Free(Chunk *chunk) noexcept
+        {
+            if (chunk->size != p_chunksize) {
+                DeleteChunk(chunk);
+                return;
+            }
+
+            chunk->next = p_spare;
+            p_spare = chunk;
+        }
+
+    private:
+        size_t  p_chunksize;
+        Chunk  *p_current;   // stack of chunks in use, last one on top
+        Chunk  *p_spare;     // released standard chunks
+        size_t  p_allocated;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArenaRewind
+     -------------------------------------------------------------------------------
+         rewinds arena to state it had at construction when goes out of scope
+
+            {
+                ArenaRewind scope(arena);
+                // temporary allocations
+            }
+    */
+
+    class ArenaRewind
+    {
+    public:
+        ArenaRewind(Arena &arena) noexcept :
+            p_arena(arena),
+            p_marker(arena.marker())
+        {}
+
+        ArenaRewind(const ArenaRewind &) = delete;
+        ArenaRewind &operator=(const ArenaRewind &) = delete;
+
+        ~ArenaRewind()
+        {
+            p_arena.Rewind(p_marker);
+        }
+
+        Arena &arena() const { return p_arena; }
+
+    private:
+        Arena          &p_arena;
+        Arena::Marker   p_marker;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArenaScope
+     -------------------------------------------------------------------------------
+         makes arena current for calling thread until scope ends, scopes
+         could be nested, previous arena is restored when scope ends
+
+         scope doesn't free anything, combine it with ArenaRewind or reset
+         arena explicitly
+    */
+
+    class ArenaScope
+    {
+    public:
+        ArenaScope(Arena &arena) noexcept :
+            p_previous(Arena::currentslot())
+        {
+            Arena::currentslot() = &arena;
+        }
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        ~ArenaScope()
+        {
+            Arena::currentslot() = p_previous;
+        }
+
+    private:
+        Arena *p_previous;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ArenaStringAllocator<T>
+     -------------------------------------------------------------------------------
+         string allocator policy which takes memory from current arena,
+         lets strings and builders live in arena:
+
+            Arena arena;
+            ArenaScope scope(arena);
+
+            ArenaStringBuilder sb;
+            sb << "id: " << id;
+            auto text = sb.MoveToString(); // ArenaString
+
+         each block keeps arena it was taken from, string or builder which
+         grows takes new block from the same arena even if other arena is
+         current now, Free() does nothing for arena blocks, memory is
+         reclaimed when arena is rewound or reset, so strings must not
+         outlive their arena allocations
+
+         without current arena strings take memory from heap and free it
+         like default allocator does
+    */
+
+    template <typename T>
+    struct ArenaStringAllocator
+    {
+        static T *Allocate(size_t count)
+        {
+            return AllocateIn(Arena::current(), count);
+        }
+
+        // new block comes from the same arena as existing block
+        static T *Allocate(size_t count, const T *block)
+        {
+            return AllocateIn(block ? owner(block) : Arena::current(), count);
+        }
+
+        static void Free(T *data) noexcept
+        {
+            if (data && owner(data) == nullptr) {
+                ::operator delete(header(data), std::align_val_t(ALIGNMENT));
+            }
+        }
+
+    private:
+        // block header holds owning arena (nullptr for heap) and keeps
+        // data aligned
+        enum : size_t
+        {
+            ALIGNMENT = alignof(T) > alignof(Arena*) ? alignof(T) : alignof(Arena*),
+            HEADER_SIZE = ALIGNMENT > sizeof(Arena*) ? ALIGNMENT : sizeof(Arena*)
+        };
+
+        static T *AllocateIn(Arena *arena, size_t count)
+        {
+            auto size = HEADER_SIZE + count * sizeof(T);
+            auto block = arena ?
+                arena->Allocate(size, ALIGNMENT) :
+                ::operator new(size, std::align_val_t(ALIGNMENT));
+
+            *static_cast<Arena**>(block) = arena;
+            return reinterpret_cast<T*>(static_cast<unsigned char*>(block) + HEADER_SIZE);
+        }
+
+        static void *header(const T *data) noexcept
+        {
+            return const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data)) - HEADER_SIZE;
+        }
+
+        static Arena *owner(const T *data) noexcept
+        {
+            return *static_cast<Arena**>(header(data));
+        }
+    };
+
+    using ArenaString = StringBase<char, StringExcludeNull, ArenaStringAllocator<char>>;
+    using ArenaStringW = StringBase<wchar_t, StringExcludeNull, ArenaStringAllocator<wchar_t>>;
+    using ArenaString32 = StringBase<char32_t, StringExcludeNull, ArenaStringAllocator<char32_t>>;
+    using ArenaStringNT = StringBase<char, StringIncludeNull, ArenaStringAllocator<char>>;
+
+    using ArenaMutableString = MutableStringBase<char, StringExcludeNull, ArenaStringAllocator<char>>;
+    using ArenaMutableStringNT = MutableStringBase<char, StringIncludeNull, ArenaStringAllocator<char>>;
+
+    using ArenaStringBuilder = DynamicStringBuilderBase<char, StringExcludeNull, ArenaStringAllocator<char>>;
+    using ArenaStringBuilderW = DynamicStringBuilderBase<wchar_t, StringExcludeNull, ArenaStringAllocator<wchar_t>>;
+    using ArenaStringBuilder32 = DynamicStringBuilderBase<char32_t, StringExcludeNull, ArenaStringAllocator<char32_t>>;
+    using ArenaStringBuilderNT = DynamicStringBuilderBase<char, StringIncludeNull, ArenaStringAllocator<char>>;
+}
@@ -0,0 +1,919 @@
+/*
+        asynchronous stream interface and file implementations
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// read/write opcodes and opcode probe appeared in 5.6 headers
+#ifdef IO_URING_OP_SUPPORTED
+#define KCOMMON_IO_URING 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define KCOMMON_COROUTINES 1
+#include <coroutine>
+#endif
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     AsyncRequest
+     -------------------------------------------------------------------------------
+         single asynchronous read or write request
+
+         request is owned by caller and should stay alive (and not be
+         modified) until its callback is called
+
+            buffer   - data buffer, destination for reads and source for writes
+            size     - amount of data to transfer
+            offset   - absolute position in stream
+            callback - called on completion from poll()/wait() of the stream
+            context  - any user data
+
+         on completion stream sets:
+            result   - actual amount of data transferred
+            error    - errno value, 0 if request succeeded
+    */
+
+    struct AsyncRequest
+    {
+        void   *buffer = nullptr;
+        size_t  size = 0;
+        size_t  offset = 0;
+        size_t  result = 0;
+        int     error = 0;
+        void  (*callback)(AsyncRequest &request) = nullptr;
+        void   *context = nullptr;
+
+        // used by stream implementation
+        AsyncRequest *next = nullptr;
+        bool          write = false;
+    };
+
+    struct AsyncResult
+    {
+        size_t size;  // actual amount of data transferred
+        int    error; // errno value, 0 on success
+    };
+
+#if KCOMMON_COROUTINES
+    class AsyncTransfer;
+#endif
+
+    /*
+     -------------------------------------------------------------------------------
+     AsyncStream
+     -------------------------------------------------------------------------------
+         asynchronous counterpart of stream interface
+
+         all transfers are done at explicit offset, there's no current
+         position, so any number of requests could be in flight at once
+
+         interface functions are:
+            submitread()  - queue read request
+            submitwrite() - queue write request
+                request - request to queue
+                result  - false if request can't be queued (stream is closed, its
+                          mode doesn't allow operation or queue is full),
+                          callback is not called in this case
+
+            poll()        - completes finished requests without waiting
+            wait()        - waits until at least mincount requests are finished and
+                            completes them
+                result  - number of completed requests
+
+                callbacks of completed requests are called from inside of these
+                functions, so completion always happens on the thread which
+                drives the stream
+
+            pending()     - number of submitted but not yet completed requests
+
+         when coroutines are available read()/write() return awaitable
+         which submits request and resumes coroutine on completion:
+            auto result = co_await stream.read(buffer, size, offset);
+    */
+
+    class AsyncStream
+    {
+    public:
+        virtual ~AsyncStream() {}
+
+        virtual bool submitread(AsyncRequest &request) = 0;
+        virtual bool submitwrite(AsyncRequest &request) = 0;
+        virtual size_t poll() = 0;
+        virtual size_t wait(size_t mincount = 1) = 0;
+        virtual size_t pending() const = 0;
+        virtual StreamMode mode() const = 0;
+        virtual size_t size() const = 0;
+
+#if KCOMMON_COROUTINES
+        inline AsyncTransfer read(void *to, size_t size, size_t offset);
+        inline AsyncTransfer write(const void *from, size_t size, size_t offset);
+#endif
+    };
+
+
+#if KCOMMON_COROUTINES
+    // awaitable for single AsyncStream transfer
+    class AsyncTransfer
+    {
+    public:
+        AsyncTransfer(AsyncStream &stream, void *buffer, size_t size, size_t offset, bool write) noexcept :
+            p_stream(stream)
+        {
+            p_request.buffer = buffer;
+            p_request.size = size;
+            p_request.offset = offset;
+            p_request.write = write;
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            p_request.context = handle.address();
+            p_request.callback = Resume;
+
+            auto submitted = p_request.write ?
+                p_stream.submitwrite(p_request) :
+                p_stream.submitread(p_request);
+
+            if (!submitted) {
+                p_request.error = EAGAIN;
+            }
+
+            // resume immediately if request wasn't submitted
+            return submitted;
+        }
+
+        AsyncResult await_resume() const noexcept
+        {
+            return { p_request.result, p_request.error };
+        }
+
+    private:
+        static void Resume(AsyncRequest &request)
+        {
+            std::coroutine_handle<>::from_address(request.context).resume();
+        }
+
+    private:
+        AsyncStream  &p_stream;
+        AsyncRequest  p_request;
+    };
+
+    AsyncTransfer AsyncStream::read(void *to, size_t size, size_t offset)
+    {
+        return AsyncTransfer(*this, to, size, offset, false);
+    }
+
+    AsyncTransfer AsyncStream::write(const void *from, size_t size, size_t offset)
+    {
+        return AsyncTransfer(*this, const_cast<void*>(from), size, offset, true);
+    }
+#endif
+
+
+    /*
+     -------------------------------------------------------------------------------
+     AsyncFileStreamBase
+     -------------------------------------------------------------------------------
+         common part of async file stream implementations, handles file
+         opening, mode and size
+
+         supported modes are Read and ReadWrite, same as for FileStream
+    */
+
+    class AsyncFileStreamBase : public AsyncStream
+    {
+    public:
+        AsyncFileStreamBase() noexcept :
+            p_handle(-1),
+            p_mode(StreamMode::Closed)
+        {}
+
+        AsyncFileStreamBase(const AsyncFileStreamBase &) = delete;
+        AsyncFileStreamBase &operator=(const AsyncFileStreamBase &) = delete;
+
+        ~AsyncFileStreamBase() override
+        {
+            CloseFile();
+        }
+
+        int handle() const noexcept { return p_handle; }
+
+        StreamMode mode() const override { return p_mode; }
+
+        size_t size() const override
+        {
+            struct stat st;
+            if (p_handle < 0 || fstat(p_handle, &st) != 0) {
+                return 0;
+            }
+            return size_t(st.st_size);
+        }
+
+    protected:
+        bool OpenFile(const char *path, StreamMode mode) noexcept
+        {
+            int flags;
+            switch (mode) {
+                case StreamMode::Read:      flags = O_RDONLY; break;
+                case StreamMode::ReadWrite: flags = O_RDWR | O_CREAT; break;
+                default: return false;
+            }
+
+            p_handle = ::open(path, flags | O_CLOEXEC, 0644);
+            if (p_handle < 0) {
+                return false;
+            }
+
+            p_mode = mode;
+            return true;
+        }
+
+        void CloseFile() noexcept
+        {
+            if (p_handle >= 0) {
+                ::close(p_handle);
+            }
+
+            p_handle = -1;
+            p_mode = StreamMode::Closed;
+        }
+
+        bool cansubmit(bool write) const noexcept
+        {
+            return p_mode == StreamMode::ReadWrite || (p_mode == StreamMode::Read && !write);
+        }
+
+        static void Complete(AsyncRequest &request)
+        {
+            if (request.callback) {
+                request.callback(request);
+            }
+        }
+
+    protected:
+        int        p_handle;
+        StreamMode p_mode;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ThreadPoolFileStream
+     -------------------------------------------------------------------------------
+         portable async file stream, requests are executed by pool of worker
+         threads with pread()/pwrite()
+
+         finished requests are collected and completed by poll()/wait() on the
+         thread which drives the stream
+    */
+
+    class ThreadPoolFileStream : public AsyncFileStreamBase
+    {
+    public:
+        ThreadPoolFileStream() noexcept :
+            p_queued(nullptr),
+            p_queuedlast(nullptr),
+            p_finished(nullptr),
+            p_finishedlast(nullptr),
+            p_pending(0),
+            p_finishedcount(0),
+            p_stop(false)
+        {}
+
+        ThreadPoolFileStream(const char *path, StreamMode mode = StreamMode::Read, unsigned threads = 4) :
+            ThreadPoolFileStream()
+        {
+            Open(path, mode, threads);
+        }
+
+        ~ThreadPoolFileStream() override
+        {
+            Close();
+        }
+
+        bool Open(const char *path, StreamMode mode = StreamMode::Read, unsigned threads = 4)
+        {
+            Close();
+
+            if (!OpenFile(path, mode)) {
+                return false;
+            }
+
+            p_stop = false;
+            for (auto n = 0u; n < c_util::umax(threads, 1u); ++n) {
+                p_workers.emplace_back([this]() { Worker(); });
+            }
+
+            return true;
+        }
+
+        // waits for all pending requests and closes file
+        void Close()
+        {
+            while (p_pending > 0) {
+                wait(p_pending);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(p_lock);
+                p_stop = true;
+            }
+            p_queuedsignal.notify_all();
+
+            for (auto &worker : p_workers) {
+                worker.join();
+            }
+            p_workers.clear();
+
+            CloseFile();
+        }
+
+        bool submitread(AsyncRequest &request) override
+        {
+            return Submit(request, false);
+        }
+
+        bool submitwrite(AsyncRequest &request) override
+        {
+            return Submit(request, true);
+        }
+
+        size_t poll() override
+        {
+            AsyncRequest *finished;
+            {
+                std::lock_guard<std::mutex> lock(p_lock);
+                finished = TakeFinished();
+            }
+
+            return CompleteAll(finished);
+        }
+
+        size_t wait(size_t mincount = 1) override
+        {
+            mincount = c_util::umin(mincount, p_pending);
+
+            AsyncRequest *finished;
+            {
+                std::unique_lock<std::mutex> lock(p_lock);
+                p_finishedsignal.wait(lock, [this, mincount]() { return p_finishedcount >= mincount; });
+                finished = TakeFinished();
+            }
+
+            return CompleteAll(finished);
+        }
+
+        size_t pending() const override
+        {
+            return p_pending;
+        }
+
+    private:
+        bool Submit(AsyncRequest &request, bool write)
+        {
+            if (!cansubmit(write)) {
+                return false;
+            }
+
+            request.write = write;
+            request.next = nullptr;
+            request.result = 0;
+            request.error = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(p_lock);
+                Append(p_queued, p_queuedlast, &request);
+            }
+            p_queuedsignal.notify_one();
+
+            ++p_pending;
+            return true;
+        }
+
+        void Worker()
+        {
+            for (;;) {
+                AsyncRequest *request;
+                {
+                    std::unique_lock<std::mutex> lock(p_lock);
+                    p_queuedsignal.wait(lock, [this]() { return p_stop || p_queued != nullptr; });
+
+                    if (p_queued == nullptr) {
+                        return;
+                    }
+
+                    request = p_queued;
+                    p_queued = request->next;
+                    if (p_queued == nullptr) {
+                        p_queuedlast = nullptr;
+                    }
+                }
+
+                Execute(*request);
+
+                {
+                    std::lock_guard<std::mutex> lock(p_lock);
+                    request->next = nullptr;
+                    Append(p_finished, p_finishedlast, request);
+                    ++p_finishedcount;
+                }
+                p_finishedsignal.notify_one();
+            }
+        }
+
+        void Execute(AsyncRequest &request)
+        {
+            auto data = static_cast<char*>(request.buffer);
+            auto total = size_t(0);
+
+            while (total < request.size) {
+                auto offset = off_t(request.offset + total);
+                auto amount = request.write ?
+                    ::pwrite(p_handle, data + total, request.size - total, offset) :
+                    ::pread(p_handle, data + total, request.size - total, offset);
+
+                if (amount < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    request.error = errno;
+                    break;
+                }
+
+                if (amount == 0) {
+                    break;
+                }
+
+                total += size_t(amount);
+            }
+
+            request.result = total;
+        }
+
+        // takes whole finished list, should be called under lock
+        AsyncRequest *TakeFinished()
+        {
+            auto finished = p_finished;
+            p_finished = p_finishedlast = nullptr;
+            p_finishedcount = 0;
+            return finished;
+        }
+
+        size_t CompleteAll(AsyncRequest *finished)
+        {
+            auto count = size_t(0);
+
+            while (finished) {
+                // callback could reuse request, so next is taken first
+                auto next = finished->next;
+                --p_pending;
+                ++count;
+                Complete(*finished);
+                finished = next;
+            }
+
+            return count;
+        }
+
+        static void Append(AsyncRequest *&first, AsyncRequest *&last, AsyncRequest *request)
+        {
+            if (last) {
+                last->next = request;
+            } else {
+                first = request;
+            }
+            last = request;
+        }
+
+    private:
+        std::vector<std::thread> p_workers;
+        std::mutex               p_lock;
+        std::condition_variable  p_queuedsignal;
+        std::condition_variable  p_finishedsignal;
+        AsyncRequest            *p_queued;
+        AsyncRequest            *p_queuedlast;
+        AsyncRequest            *p_finished;
+        AsyncRequest            *p_finishedlast;
+        size_t                   p_pending;       // accessed only by driving thread
+        size_t                   p_finishedcount;
+        bool                     p_stop;
+    };
+
+
+#if KCOMMON_IO_URING
+    /*
+     -------------------------------------------------------------------------------
+     UringFileStream
+     -------------------------------------------------------------------------------
+         Linux io_uring async file stream
+
+         rings are set up with raw system calls, so no liburing dependency
+
+         submit functions only fill submission queue entries, they are passed
+         to kernel in batch by next poll()/wait() call (or when submission
+         queue gets full), so submitting N requests and waiting for them costs
+         single system call
+
+         number of requests in flight is limited by queue depth given to Open()
+
+         stream can't be opened if kernel doesn't support read and write
+         operations (they are available since 5.6), large requests are
+         transferred by chunks and short transfers are resubmitted, so
+         requests complete the same way as with ThreadPoolFileStream
+    */
+
+    class UringFileStream : public AsyncFileStreamBase
+    {
+    public:
+        enum
+        {
+            MAX_TRANSFER = 1 << 30 // max amount of data for single operation
+        };
+
+    public:
+        UringFileStream() noexcept :
+            p_ring(-1),
+            p_sqmemory(nullptr),
+            p_sqmemorysize(0),
+            p_cqmemory(nullptr),
+            p_cqmemorysize(0),
+            p_sqes(nullptr),
+            p_sqessize(0),
+            p_sqhead(nullptr),
+            p_sqtail(nullptr),
+            p_sqmask(0),
+            p_sqarray(nullptr),
+            p_cqhead(nullptr),
+            p_cqtail(nullptr),
+            p_cqmask(0),
+            p_cqes(nullptr),
+            p_depth(0),
+            p_unsubmitted(0),
+            p_pending(0)
+        {}
+
+        UringFileStream(const char *path, StreamMode mode = StreamMode::Read, unsigned queuedepth = 64) noexcept :
+            UringFileStream()
+        {
+            Open(path, mode, queuedepth);
+        }
+
+        ~UringFileStream() override
+        {
+            Close();
+        }
+
+        // returns false if file can't be opened or io_uring is not available
+        bool Open(const char *path, StreamMode mode = StreamMode::Read, unsigned queuedepth = 64) noexcept
+        {
+            Close();
+
+            if (!SetupRing(queuedepth)) {
+                CloseRing();
+                return false;
+            }
+
+            if (!OpenFile(path, mode)) {
+                CloseRing();
+                return false;
+            }
+
+            return true;
+        }
+
+        // waits for all pending requests and closes file
+        void Close() noexcept
+        {
+            while (p_pending > 0) {
+                if (wait(p_pending) == 0) {
+                    break;
+                }
+            }
+
+            CloseFile();
+            CloseRing();
+        }
+
+        bool submitread(AsyncRequest &request) override
+        {
+            return Submit(request, false);
+        }
+
+        bool submitwrite(AsyncRequest &request) override
+        {
+            return Submit(request, true);
+        }
+
+        size_t poll() override
+        {
+            Enter(0);
+            return Reap();
+        }
+
+        size_t wait(size_t mincount = 1) override
+        {
+            mincount = c_util::umin(mincount, p_pending);
+
+            auto count = Reap();
+            while (count < mincount) {
+                if (!Enter(unsigned(mincount - count))) {
+                    break;
+                }
+                count += Reap();
+            }
+
+            return count;
+        }
+
+        size_t pending() const override
+        {
+            return p_pending;
+        }
+
+    private:
+        bool SetupRing(unsigned queuedepth) noexcept
+        {
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+
+            p_ring = int(syscall(__NR_io_uring_setup, c_util::umax(queuedepth, 1u), &params));
+            if (p_ring < 0 || !Supported()) {
+                return false;
+            }
+
+            p_sqmemorysize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            p_cqmemorysize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            auto single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) {
+                p_sqmemorysize = p_cqmemorysize = c_util::umax(p_sqmemorysize, p_cqmemorysize);
+            }
+
+            p_sqmemory = Map(p_sqmemorysize, IORING_OFF_SQ_RING);
+            if (p_sqmemory == nullptr) {
+                return false;
+            }
+
+            if (single) {
+                p_cqmemory = p_sqmemory;
+            } else {
+                p_cqmemory = Map(p_cqmemorysize, IORING_OFF_CQ_RING);
+                if (p_cqmemory == nullptr) {
+                    return false;
+                }
+            }
+
+            p_sqessize = params.sq_entries * sizeof(io_uring_sqe);
+            p_sqes = static_cast<io_uring_sqe*>(Map(p_sqessize, IORING_OFF_SQES));
+            if (p_sqes == nullptr) {
+                return false;
+            }
+
+            auto sq = static_cast<char*>(p_sqmemory);
+            p_sqhead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            p_sqtail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            p_sqmask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            p_sqarray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+            auto cq = static_cast<char*>(p_cqmemory);
+            p_cqhead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            p_cqtail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            p_cqmask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            p_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            // keep number of requests in flight within completion queue size
+            p_depth = c_util::umin(params.sq_entries, params.cq_entries);
+
+            return true;
+        }
+
+        // checks if kernel supports read and write operations, kernels
+        // older than 5.6 fail probe itself
+        bool Supported() noexcept
+        {
+            enum { PROBE_OPS = 256 };
+
+            alignas(io_uring_probe) unsigned char buffer[sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)];
+            memset(buffer, 0, sizeof(buffer));
+
+            auto probe = reinterpret_cast<io_uring_probe*>(buffer);
+            if (syscall(__NR_io_uring_register, p_ring, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+                return false;
+            }
+
+            auto supported = [probe](unsigned op) {
+                return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            };
+
+            return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+        }
+
+        void *Map(size_t size, unsigned long long offset) noexcept
+        {
+            auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p_ring, off_t(offset));
+            return memory == MAP_FAILED ? nullptr : memory;
+        }
+
+        void CloseRing() noexcept
+        {
+            if (p_sqes) {
+                munmap(p_sqes, p_sqessize);
+            }
+            if (p_cqmemory && p_cqmemory != p_sqmemory) {
+                munmap(p_cqmemory, p_cqmemorysize);
+            }
+            if (p_sqmemory) {
+                munmap(p_sqmemory, p_sqmemorysize);
+            }
+            if (p_ring >= 0) {
+                ::close(p_ring);
+            }
+
+            p_ring = -1;
+            p_sqmemory = p_cqmemory = nullptr;
+            p_sqes = nullptr;
+            p_unsubmitted = 0;
+            p_pending = 0;
+        }
+
+        bool Submit(AsyncRequest &request, bool write) noexcept
+        {
+            if (!cansubmit(write) || p_pending == p_depth) {
+                return false;
+            }
+
+            request.write = write;
+            request.result = 0;
+            request.error = 0;
+
+            auto tail = *p_sqtail;
+            if ((tail - __atomic_load_n(p_sqhead, __ATOMIC_ACQUIRE)) > p_sqmask) {
+                // submission queue is full, pass entries to kernel
+                if (!Enter(0) || (tail - __atomic_load_n(p_sqhead, __ATOMIC_ACQUIRE)) > p_sqmask) {
+                    return false;
+                }
+            }
+
+            Queue(request);
+            ++p_pending;
+
+            return true;
+        }
+
+        // fills submission entry for not yet transferred part of request,
+        // there must be free entry in submission queue
+        void Queue(AsyncRequest &request) noexcept
+        {
+            auto tail = *p_sqtail;
+            auto index = tail & p_sqmask;
+            auto &sqe = p_sqes[index];
+            memset(&sqe, 0, sizeof(sqe));
+
+            auto done = request.result;
+
+            sqe.opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe.fd = p_handle;
+            sqe.addr = reinterpret_cast<unsigned long long>(static_cast<char*>(request.buffer) + done);
+            sqe.len = unsigned(c_util::umin(request.size - done, size_t(MAX_TRANSFER)));
+            sqe.off = request.offset + done;
+            sqe.user_data = reinterpret_cast<unsigned long long>(&request);
+
+            p_sqarray[index] = index;
+            __atomic_store_n(p_sqtail, tail + 1, __ATOMIC_RELEASE);
+
+            ++p_unsubmitted;
+        }
+
+        // passes unsubmitted entries to kernel and optionally waits for completions
+        bool Enter(unsigned mincomplete) noexcept
+        {
+            if (p_unsubmitted == 0 && mincomplete == 0) {
+                return true;
+            }
+
+            for (;;) {
+                auto flags = mincomplete ? IORING_ENTER_GETEVENTS : 0u;
+                auto result = syscall(__NR_io_uring_enter, p_ring, p_unsubmitted, mincomplete, flags, nullptr, 0);
+
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+
+                p_unsubmitted -= unsigned(result);
+                return true;
+            }
+        }
+
+        size_t Reap() noexcept
+        {
+            auto count = size_t(0);
+            auto head = *p_cqhead;
+
+            for (;;) {
+                if (head == __atomic_load_n(p_cqtail, __ATOMIC_ACQUIRE)) {
+                    break;
+                }
+
+                auto &cqe = p_cqes[head & p_cqmask];
+                auto &request = *reinterpret_cast<AsyncRequest*>(cqe.user_data);
+
+                ++head;
+                __atomic_store_n(p_cqhead, head, __ATOMIC_RELEASE);
+
+                if (cqe.res < 0) {
+                    request.error = -cqe.res;
+                } else {
+                    request.result += size_t(cqe.res);
+
+                    // short or chunked transfer, rest of request is queued
+                    // again, request keeps its submission queue entry because
+                    // number of requests in flight is within queue size
+                    if (cqe.res > 0 && request.result < request.size) {
+                        Queue(request);
+                        continue;
+                    }
+                }
+
+                --p_pending;
+                ++count;
+
+                Complete(request);
+            }
+
+            return count;
+        }
+
+    private:
+        int           p_ring;
+        void         *p_sqmemory;
+        size_t        p_sqmemorysize;
+        void         *p_cqmemory;
+        size_t        p_cqmemorysize;
+        io_uring_sqe *p_sqes;
+        size_t        p_sqessize;
+        unsigned     *p_sqhead;
+        unsigned     *p_sqtail;
+        unsigned      p_sqmask;
+        unsigned     *p_sqarray;
+        unsigned     *p_cqhead;
+        unsigned     *p_cqtail;
+        unsigned      p_cqmask;
+        io_uring_cqe *p_cqes;
+        size_t        p_depth;       // max requests in flight
+        unsigned      p_unsubmitted; // entries queued but not passed to kernel yet
+        size_t        p_pending;
+    };
+#endif
+
+
+    // opens file with the best available async implementation,
+    // returns nullptr if file can't be opened
+    inline std::unique_ptr<AsyncStream> OpenAsyncFileStream(const char *path, StreamMode mode = StreamMode::Read, unsigned queuedepth = 64)
+    {
+#if KCOMMON_IO_URING
+        auto uring = std::make_unique<UringFileStream>();
+        if (uring->Open(path, mode, queuedepth)) {
+            return uring;
+        }
+#endif
+
+        auto pool = std::make_unique<ThreadPoolFileStream>();
+        if (pool->Open(path, mode)) {
+            return pool;
+        }
+
+        return nullptr;
+    }
+}
@@ -0,0 +1,503 @@
+/*
+        buffered stream adapters
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include <cstring>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     bufferedreaderT<T, B>
+     -------------------------------------------------------------------------------
+         read buffering adapter around any streamT<T>
+
+         source stream is read in chunks of buffer size, small reads are served
+         from the buffer by inline non virtual functions:
+            peek()     - get next byte without consuming it
+            readbyte() - read single byte
+            read<V>()  - read trivially copyable value
+
+         reader itself is a stream (B is streamT<T> or derived interface like
+         Stream), so it could be passed anywhere source stream could be used
+
+         mode of reader is read only version of source mode:
+            Read, ReadWrite                  -> Read
+            SequentialRead                   -> SequentialRead
+            StreamRead, StreamReadWrite      -> StreamRead
+            any write only mode              -> Closed
+
+         seek() is allowed only for Read mode, seeking inside buffered data
+         doesn't touch source stream
+
+         position() for stream modes returns total amount of data read
+
+         readat() bypasses buffer and goes directly to source stream, so it's
+         as thread safe as source readat()
+
+         reader doesn't own source stream, source should not be used directly
+         while reader is in use, as reader has its own idea of current position
+    */
+
+    template <typename T, typename B = streamT<T>>
+    class bufferedreaderT : public B
+    {
+    public:
+        bufferedreaderT(streamT<T> &source, T buffersize = 64 * 1024) :
+            p_source(source),
+            p_buffer(new unsigned char[buffersize]),
+            p_capacity(buffersize),
+            p_current(p_buffer),
+            p_end(p_buffer),
+            p_bufferstart(0)
+        {
+            if (hasposition()) {
+                p_bufferstart = p_source.position();
+            }
+        }
+
+        bufferedreaderT(const bufferedreaderT<T, B> &) = delete;
+        bufferedreaderT<T, B> &operator=(const bufferedreaderT<T, B> &) = delete;
+
+        ~bufferedreaderT() override
+        {
+            delete[] p_buffer;
+        }
+
+        streamT<T> &source() const { return p_source; }
+
+        // amount of data available in buffer without reading source stream
+        T buffered() const { return T(p_end - p_current); }
+
+        bool peek(unsigned char &value)
+        {
+            if (p_current == p_end && !Fill()) {
+                return false;
+            }
+
+            value = *p_current;
+            return true;
+        }
+
+        bool readbyte(unsigned char &value)
+        {
+            if (p_current == p_end && !Fill()) {
+                return false;
+            }
+
+            value = *p_current++;
+            return true;
+        }
+
+        // reads whole value or nothing (if stream has less data than value size)
+        template <typename V>
+        bool read(V &value)
+        {
+            if (sizeof(V) <= size_t(p_end - p_current)) {
+                memcpy(&value, p_current, sizeof(V));
+                p_current += sizeof(V);
+                return true;
+            }
+
+            return ReadValueSlow(&value, sizeof(V));
+        }
+
+        // streamT interface
+        T read(void *to, T size) override
+        {
+            auto dest = static_cast<unsigned char*>(to);
+            auto total = T(0);
+
+            while (size > 0) {
+                auto available = T(p_end - p_current);
+
+                if (available == 0) {
+                    // large reads bypass buffer
+                    if (size >= p_capacity) {
+                        Discard();
+                        auto amount = p_source.read(dest, size);
+                        p_bufferstart += amount;
+                        total += amount;
+                        break;
+                    }
+
+                    if (!Fill()) {
+                        break;
+                    }
+                    continue;
+                }
+
+                auto amount = c_util::umin(available, size);
+                memcpy(dest, p_current, amount);
+                p_current += amount;
+                dest += amount;
+                size -= amount;
+                total += amount;
+            }
+
+            return total;
+        }
+
+        T write(const void *, T) override
+        {
+            return 0;
+        }
+
+        T seek(T newpos, SeekOrigin origin = SeekOrigin::Begin) override
+        {
+            if (mode() != StreamMode::Read) {
+                return 0;
+            }
+
+            auto target = this->seekposition(newpos, origin, position(), size());
+
+            // still inside buffered data
+            auto bufferend = p_bufferstart + T(p_end - p_buffer);
+            if (target >= p_bufferstart && target <= bufferend) {
+                p_current = p_buffer + (target - p_bufferstart);
+                return target;
+            }
+
+            Discard();
+            p_bufferstart = p_source.seek(target);
+
+            return p_bufferstart;
+        }
+
+        StreamMode mode() const override
+        {
+            switch (p_source.mode()) {
+                case StreamMode::Read:
+                case StreamMode::ReadWrite:
+                    return StreamMode::Read;
+
+                case StreamMode::SequentialRead:
+                    return StreamMode::SequentialRead;
+
+                case StreamMode::StreamRead:
+                case StreamMode::StreamReadWrite:
+                    return StreamMode::StreamRead;
+
+                default:
+                    return StreamMode::Closed;
+            }
+        }
+
+        T position() const override
+        {
+            return p_bufferstart + T(p_current - p_buffer);
+        }
+
+        T size() const override
+        {
+            return p_source.size();
+        }
+
+        T readat(void *to, T size, T offset) override
+        {
+            if (mode() != StreamMode::Read) {
+                return 0;
+            }
+
+            return p_source.readat(to, size, offset);
+        }
+
+        T writeat(const void *, T, T) override
+        {
+            return 0;
+        }
+
+    private:
+        bool hasposition() const
+        {
+            auto m = p_source.mode();
+            return m == StreamMode::Read || m == StreamMode::ReadWrite || m == StreamMode::SequentialRead;
+        }
+
+        // drops buffered data, buffer start becomes current position
+        void Discard()
+        {
+            p_bufferstart += T(p_current - p_buffer);
+            p_current = p_end = p_buffer;
+        }
+
+        // refills empty buffer, returns false if source has no more data
+        bool Fill()
+        {
+            Discard();
+
+            auto amount = p_source.read(p_buffer, p_capacity);
+            p_end = p_buffer + amount;
+
+            return amount > 0;
+        }
+
+        bool ReadValueSlow(void *to, size_t size)
+        {
+            auto available = size_t(p_end - p_current);
+
+            // value doesn't fit into buffer, leftover is copied and the rest
+            // is read directly, partial value is lost if source has no more data
+            if (size > size_t(p_capacity)) {
+                auto dest = static_cast<unsigned char*>(to);
+                memcpy(dest, p_current, available);
+                p_current += available;
+                Discard();
+
+                auto total = available;
+                while (total < size) {
+                    auto amount = p_source.read(dest + total, T(size - total));
+                    if (amount == 0) {
+                        return false;
+                    }
+                    p_bufferstart += amount;
+                    total += amount;
+                }
+
+                return true;
+            }
+
+            // move leftover to buffer start and read the rest after it
+            // so partial value isn't lost when source has no more data
+            memmove(p_buffer, p_current, available);
+            p_bufferstart += T(p_current - p_buffer);
+            p_current = p_buffer;
+            p_end = p_buffer + available;
+
+            while (size_t(p_end - p_buffer) < size) {
+                auto amount = p_source.read(p_end, p_capacity - T(p_end - p_buffer));
+                if (amount == 0) {
+                    return false;
+                }
+                p_end += amount;
+            }
+
+            memcpy(to, p_current, size);
+            p_current += size;
+
+            return true;
+        }
+
+    private:
+        streamT<T>    &p_source;
+        unsigned char *p_buffer;
+        T              p_capacity;
+        unsigned char *p_current;     // next byte to read
+        unsigned char *p_end;         // end of valid buffered data
+        T              p_bufferstart; // stream position of the first buffer byte
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     bufferedwriterT<T, B>
+     -------------------------------------------------------------------------------
+         write buffering adapter around any streamT<T>
+
+         small writes are collected in the buffer and written to source stream
+         in buffer size chunks, inline non virtual functions:
+            writebyte() - write single byte
+            write<V>()  - write trivially copyable value
+
+         writes which are larger than buffer are written directly
+
+         mode of writer is the mode of source stream (read only modes are
+         reported as Closed), for ReadWrite and StreamReadWrite modes read()
+         flushes pending data and reads from source directly
+
+         seek() is allowed only for ReadWrite mode, it flushes pending data
+
+         Flush() is called on destruction, but write errors are lost there,
+         call Flush() explicitly to check that all data got written
+    */
+
+    template <typename T, typename B = streamT<T>>
+    class bufferedwriterT : public B
+    {
+    public:
+        bufferedwriterT(streamT<T> &destination, T buffersize = 64 * 1024) :
+            p_destination(destination),
+            p_buffer(new unsigned char[buffersize]),
+            p_capacity(buffersize),
+            p_current(p_buffer),
+            p_bufferstart(0)
+        {
+            if (hasposition()) {
+                p_bufferstart = p_destination.position();
+            }
+        }
+
+        bufferedwriterT(const bufferedwriterT<T, B> &) = delete;
+        bufferedwriterT<T, B> &operator=(const bufferedwriterT<T, B> &) = delete;
+
+        ~bufferedwriterT() override
+        {
+            Flush();
+            delete[] p_buffer;
+        }
+
+        streamT<T> &destination() const { return p_destination; }
+
+        // amount of data waiting in buffer
+        T pending() const { return T(p_current - p_buffer); }
+
+        bool writebyte(unsigned char value)
+        {
+            if (p_current == p_buffer + p_capacity && !Flush()) {
+                return false;
+            }
+
+            *p_current++ = value;
+            return true;
+        }
+
+        template <typename V>
+        bool write(const V &value)
+        {
+            if (sizeof(V) <= size_t(p_buffer + p_capacity - p_current)) {
+                memcpy(p_current, &value, sizeof(V));
+                p_current += sizeof(V);
+                return true;
+            }
+
+            return write(&value, T(sizeof(V))) == sizeof(V);
+        }
+
+        // writes all pending data to destination stream
+        bool Flush()
+        {
+            auto count = T(p_current - p_buffer);
+            if (count == 0) {
+                return true;
+            }
+
+            auto written = p_destination.write(p_buffer, count);
+            p_bufferstart += written;
+
+            if (written < count) {
+                // keep data which wasn't written
+                memmove(p_buffer, p_buffer + written, count - written);
+                p_current = p_buffer + (count - written);
+                return false;
+            }
+
+            p_current = p_buffer;
+            return true;
+        }
+
+        // streamT interface
+        T read(void *to, T size) override
+        {
+            auto m = mode();
+            if ((m != StreamMode::ReadWrite && m != StreamMode::StreamReadWrite) || !Flush()) {
+                return 0;
+            }
+
+            auto amount = p_destination.read(to, size);
+            p_bufferstart += amount;
+
+            return amount;
+        }
+
+        T write(const void *from, T size) override
+        {
+            auto space = T(p_buffer + p_capacity - p_current);
+            if (size <= space) {
+                memcpy(p_current, from, size);
+                p_current += size;
+                return size;
+            }
+
+            if (!Flush()) {
+                return 0;
+            }
+
+            if (size >= p_capacity) {
+                auto written = p_destination.write(from, size);
+                p_bufferstart += written;
+                return written;
+            }
+
+            memcpy(p_current, from, size);
+            p_current += size;
+
+            return size;
+        }
+
+        T seek(T newpos, SeekOrigin origin = SeekOrigin::Begin) override
+        {
+            if (mode() != StreamMode::ReadWrite || !Flush()) {
+                return 0;
+            }
+
+            p_bufferstart = p_destination.seek(newpos, origin);
+            return p_bufferstart;
+        }
+
+        StreamMode mode() const override
+        {
+            auto m = p_destination.mode();
+            switch (m) {
+                case StreamMode::StreamWrite:
+                case StreamMode::SequentialWrite:
+                case StreamMode::StreamReadWrite:
+                case StreamMode::ReadWrite:
+                    return m;
+
+                default:
+                    return StreamMode::Closed;
+            }
+        }
+
+        T position() const override
+        {
+            return p_bufferstart + T(p_current - p_buffer);
+        }
+
+        T size() const override
+        {
+            return c_util::umax(p_destination.size(), position());
+        }
+
+    private:
+        bool hasposition() const
+        {
+            auto m = p_destination.mode();
+            return m == StreamMode::ReadWrite || m == StreamMode::SequentialWrite;
+        }
+
+    private:
+        streamT<T>    &p_destination;
+        unsigned char *p_buffer;
+        T              p_capacity;
+        unsigned char *p_current;     // next byte to write
+        T              p_bufferstart; // stream position of the first buffer byte
+    };
+
+
+    class BufferedReader : public bufferedreaderT<size_t, Stream>
+    {
+    public:
+        BufferedReader(streamT<size_t> &source, size_t buffersize = 64 * 1024) :
+            bufferedreaderT<size_t, Stream>(source, buffersize)
+        {}
+    };
+
+    class BufferedWriter : public bufferedwriterT<size_t, Stream>
+    {
+    public:
+        BufferedWriter(streamT<size_t> &destination, size_t buffersize = 64 * 1024) :
+            bufferedwriterT<size_t, Stream>(destination, buffersize)
+        {}
+    };
+}
@@ -0,0 +1,724 @@
+/*
+        compressed stream filters
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     LZBlockCodec
+     -------------------------------------------------------------------------------
+         fast LZ77 family block codec, compressed format is LZ4 block format:
+         sequence of [token][literal length][literals][offset][match length]
+
+            token            - high 4 bits literal count, low 4 bits match
+                               length minus 4, value 15 means length continues
+                               in following bytes (each 255 adds and continues)
+            offset           - 16 bit little endian distance back to match
+            last sequence    - has literals only
+
+         every block is independent, decompressor checks all bounds and
+         fails on malformed input instead of reading or writing out of bounds
+    */
+
+    class LZBlockCodec
+    {
+    public:
+        enum {
+            MIN_MATCH     = 4,
+            MAX_OFFSET    = 65535,
+            HASH_BITS     = 14,
+            LAST_LITERALS = 5,  // block always ends with at least this literals
+            MATCH_LIMIT   = 12  // no match starts closer than this to the end
+        };
+
+        // worst case compressed size for given source size
+        static size_t bound(size_t size) noexcept
+        {
+            return size + size / 255 + 16;
+        }
+
+        // returns compressed size, or 0 if result doesn't fit capacity
+        static size_t Compress(const unsigned char *source, size_t size, unsigned char *dest, size_t capacity) noexcept
+        {
+            auto op = dest;
+            auto oend = dest + capacity;
+            auto anchor = source;
+
+            if (size > MATCH_LIMIT) {
+                uint32_t table[1 << HASH_BITS];
+                memset(table, 0, sizeof(table));
+
+                auto ip = source;
+                auto limit = source + size - MATCH_LIMIT;
+                auto matchlimit = source + size - LAST_LITERALS;
+
+                while (ip < limit) {
+                    auto sequence = read32(ip);
+                    auto &slot = table[hash(sequence)];
+                    auto ref = source + slot;
+                    slot = uint32_t(ip - source);
+
+                    auto distance = size_t(ip - ref);
+                    if (distance == 0 || distance > MAX_OFFSET || read32(ref) != sequence) {
+                        // skip faster through data which doesn't compress
+                        ip += 1 + (size_t(ip - anchor) >> 6);
+                        continue;
+                    }
+
+                    // extend match backwards over pending literals
+                    while (ip > anchor && ref > source && ip[-1] == ref[-1]) {
+                        --ip;
+                        --ref;
+                    }
+
+                    auto length = size_t(MIN_MATCH);
+                    while (ip + length < matchlimit && ip[length] == ref[length]) {
+                        ++length;
+                    }
+
+                    auto literals = size_t(ip - anchor);
+                    if (size_t(oend - op) < literals + literals / 255 + length / 255 + 8) {
+                        return 0;
+                    }
+
+                    auto token = op++;
+                    *token = uint8_t(putlength(op, literals) << 4);
+                    memcpy(op, anchor, literals);
+                    op += literals;
+
+                    *op++ = uint8_t(distance);
+                    *op++ = uint8_t(distance >> 8);
+                    *token |= putlength(op, length - MIN_MATCH);
+
+                    ip += length;
+                    anchor = ip;
+                }
+            }
+
+            auto literals = size_t(source + size - anchor);
+            if (size_t(oend - op) < literals + literals / 255 + 2) {
+                return 0;
+            }
+
+            auto token = op++;
+            *token = uint8_t(putlength(op, literals) << 4);
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            return size_t(op - dest);
+        }
+
+        // decompresses block which must produce exactly size bytes
+        static bool Decompress(const unsigned char *source, size_t size, unsigned char *dest, size_t destsize) noexcept
+        {
+            auto ip = source;
+            auto end = source + size;
+            auto op = dest;
+            auto oend = dest + destsize;
+
+            while (ip < end) {
+                auto token = *ip++;
+
+                auto literals = size_t(token >> 4);
+                if (literals == 15 && !getlength(ip, end, literals)) {
+                    return false;
+                }
+
+                if (size_t(end - ip) < literals || size_t(oend - op) < literals) {
+                    return false;
+                }
+
+                memcpy(op, ip, literals);
+                ip += literals;
+                op += literals;
+
+                // last sequence has no match part
+                if (ip == end) {
+                    break;
+                }
+
+                if (end - ip < 2) {
+                    return false;
+                }
+
+                auto distance = size_t(ip[0]) | (size_t(ip[1]) << 8);
+                ip += 2;
+
+                auto length = size_t(token & 15);
+                if (length == 15 && !getlength(ip, end, length)) {
+                    return false;
+                }
+                length += MIN_MATCH;
+
+                if (distance == 0 || distance > size_t(op - dest) || size_t(oend - op) < length) {
+                    return false;
+                }
+
+                auto ref = op - distance;
+                if (distance >= length) {
+                    memcpy(op, ref, length);
+                    op += length;
+                } else {
+                    // overlapping match repeats last distance bytes
+                    for (auto n = size_t(0); n < length; ++n) {
+                        *op++ = *ref++;
+                    }
+                }
+            }
+
+            return op == oend;
+        }
+
+    private:
+        static uint32_t read32(const unsigned char *p) noexcept
+        {
+            uint32_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        static uint32_t hash(uint32_t sequence) noexcept
+        {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // writes extra length bytes, returns token nibble
+        static uint8_t putlength(unsigned char *&op, size_t length) noexcept
+        {
+            if (length < 15) {
+                return uint8_t(length);
+            }
+
+            length -= 15;
+            while (length >= 255) {
+                *op++ = 255;
+                length -= 255;
+            }
+            *op++ = uint8_t(length);
+
+            return 15;
+        }
+
+        static bool getlength(const unsigned char *&ip, const unsigned char *end, size_t &length) noexcept
+        {
+            unsigned char value;
+            do {
+                if (ip == end) {
+                    return false;
+                }
+                value = *ip++;
+                length += value;
+            } while (value == 255);
+
+            return true;
+        }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     compressed stream format
+     -------------------------------------------------------------------------------
+         compressed stream is a sequence of blocks, every block starts with
+         8 byte header (two 32 bit little endian values):
+            raw size         - size of uncompressed block data
+            packed size      - size of block data which follows header,
+                               if it's equal to raw size block is stored
+                               uncompressed
+
+         block with zero raw size marks end of compressed data, so compressed
+         data could be followed by something else in the same stream
+    */
+
+    enum {
+        COMPRESSED_BLOCK_HEADER = 8,
+        COMPRESSED_MAX_BLOCK    = 16 * 1024 * 1024
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     CompressedWriter
+     -------------------------------------------------------------------------------
+         compressing write filter around any streamT<size_t>
+
+         written data is collected in blocks of blocksize and every full
+         block is compressed independently and written to destination,
+         with threads > 1 writer collects that many blocks, compresses them
+         in parallel and writes them in original order
+
+         parallel writer keeps threads worker threads for its lifetime and
+         two batches of blocks, while one batch is being compressed previous
+         one is written and next one is filled, so write error could be
+         reported by one of following calls, after error nothing is written
+
+         mode of writer is StreamWrite, position() is amount of uncompressed
+         data written
+
+         Flush() compresses and writes collected data (creating short block),
+         Finish() flushes and writes end mark, it's called on destruction,
+         but errors are lost there, call Finish() explicitly to check that
+         all data got written, after Finish() writer is Closed
+    */
+
+    class CompressedWriter : public Stream
+    {
+    public:
+        CompressedWriter(streamT<size_t> &destination, size_t blocksize = 256 * 1024, size_t threads = 1) :
+            p_destination(destination),
+            p_blocksize(c_util::umin(c_util::umax(blocksize, size_t(1024)), size_t(COMPRESSED_MAX_BLOCK))),
+            p_batch(c_util::umax(threads, size_t(1))),
+            p_blocks(p_batch > 1 ? p_batch * 2 : 1),
+            p_fill(0),
+            p_current(0),
+            p_inflight(0),
+            p_next(0),
+            p_end(0),
+            p_remaining(0),
+            p_position(0),
+            p_finished(false),
+            p_failed(false),
+            p_stop(false)
+        {
+            for (auto &block : p_blocks) {
+                block.raw = new unsigned char[p_blocksize];
+                block.packed = new unsigned char[p_blocksize];
+            }
+
+            if (p_batch > 1) {
+                for (auto n = size_t(0); n < p_batch; ++n) {
+                    p_workers.emplace_back([this]() { Worker(); });
+                }
+            }
+        }
+
+        CompressedWriter(const CompressedWriter &) = delete;
+        CompressedWriter &operator=(const CompressedWriter &) = delete;
+
+        ~CompressedWriter() override
+        {
+            Finish();
+
+            {
+                std::lock_guard<std::mutex> lock(p_lock);
+                p_stop = true;
+            }
+            p_queuedsignal.notify_all();
+
+            for (auto &worker : p_workers) {
+                worker.join();
+            }
+
+            for (auto &block : p_blocks) {
+                delete[] block.raw;
+                delete[] block.packed;
+            }
+        }
+
+        streamT<size_t> &destination() const { return p_destination; }
+
+        bool Flush()
+        {
+            return WriteBlocks(p_current + (p_blocks[p_fill + p_current].rawsize > 0), true);
+        }
+
+        bool Finish()
+        {
+            if (p_finished) {
+                return true;
+            }
+
+            p_finished = true;
+
+            unsigned char header[COMPRESSED_BLOCK_HEADER] = {};
+            return Flush() && p_destination.write(header, sizeof(header)) == sizeof(header);
+        }
+
+        // streamT interface
+        size_t read(void *, size_t) override
+        {
+            return 0;
+        }
+
+        size_t write(const void *from, size_t size) override
+        {
+            if (p_finished) {
+                return 0;
+            }
+
+            auto source = static_cast<const unsigned char*>(from);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto &block = p_blocks[p_fill + p_current];
+                auto amount = c_util::umin(size - total, p_blocksize - block.rawsize);
+
+                memcpy(block.raw + block.rawsize, source + total, amount);
+                block.rawsize += amount;
+                total += amount;
+
+                if (block.rawsize == p_blocksize && ++p_current == p_batch && !WriteBlocks(p_current, false)) {
+                    break;
+                }
+            }
+
+            p_position += total;
+            return total;
+        }
+
+        size_t seek(size_t, SeekOrigin = SeekOrigin::Begin) override
+        {
+            return 0;
+        }
+
+        StreamMode mode() const override { return p_finished ? StreamMode::Closed : StreamMode::StreamWrite; }
+        size_t position() const override { return p_position; }
+        size_t size() const override { return p_position; }
+
+    private:
+        struct Block
+        {
+            unsigned char *raw = nullptr;
+            unsigned char *packed = nullptr;
+            size_t         rawsize = 0;
+            size_t         packedsize = 0;
+        };
+
+        static void CompressBlock(Block &block)
+        {
+            // packed data must be smaller than raw, otherwise block is stored
+            block.packedsize = LZBlockCodec::Compress(
+                block.raw, block.rawsize, block.packed, block.rawsize - 1
+            );
+        }
+
+        static void PutU32(unsigned char *to, size_t value)
+        {
+            to[0] = uint8_t(value);
+            to[1] = uint8_t(value >> 8);
+            to[2] = uint8_t(value >> 16);
+            to[3] = uint8_t(value >> 24);
+        }
+
+        void Worker()
+        {
+            std::unique_lock<std::mutex> lock(p_lock);
+
+            for (;;) {
+                p_queuedsignal.wait(lock, [this]() { return p_stop || p_next < p_end; });
+
+                if (p_next == p_end) {
+                    return;
+                }
+
+                auto &block = p_blocks[p_next++];
+
+                lock.unlock();
+                CompressBlock(block);
+                lock.lock();
+
+                if (--p_remaining == 0) {
+                    p_donesignal.notify_one();
+                }
+            }
+        }
+
+        // passes count blocks starting from first to workers
+        void Dispatch(size_t first, size_t count)
+        {
+            {
+                std::lock_guard<std::mutex> lock(p_lock);
+                p_next = first;
+                p_end = first + count;
+                p_remaining = count;
+            }
+            p_queuedsignal.notify_all();
+        }
+
+        // waits until dispatched blocks are compressed
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(p_lock);
+            p_donesignal.wait(lock, [this]() { return p_remaining == 0; });
+        }
+
+        // writes count compressed blocks starting from first, blocks are
+        // emptied even if writing fails
+        bool WriteBatch(size_t first, size_t count)
+        {
+            for (auto n = first; n < first + count; ++n) {
+                auto &block = p_blocks[n];
+                auto stored = block.packedsize == 0;
+                auto payload = stored ? block.rawsize : block.packedsize;
+
+                unsigned char header[COMPRESSED_BLOCK_HEADER];
+                PutU32(header, block.rawsize);
+                PutU32(header + 4, payload);
+
+                Span<unsigned char> parts[] = {
+                    Span<unsigned char>(header, sizeof(header)),
+                    Span<unsigned char>(stored ? block.raw : block.packed, payload)
+                };
+
+                if (!p_failed && p_destination.writev(parts) != sizeof(header) + payload) {
+                    p_failed = true;
+                }
+
+                block.rawsize = 0;
+            }
+
+            return !p_failed;
+        }
+
+        // compresses count filled blocks of current batch and writes them,
+        // parallel writer writes previous batch instead while current one is
+        // being compressed, flush writes everything
+        bool WriteBlocks(size_t count, bool flush)
+        {
+            if (p_workers.empty()) {
+                for (auto n = size_t(0); n < count; ++n) {
+                    CompressBlock(p_blocks[n]);
+                }
+
+                p_current = 0;
+                return WriteBatch(0, count);
+            }
+
+            // previous batch must be compressed before it's written
+            Wait();
+
+            auto previous = p_batch - p_fill;
+            Dispatch(p_fill, count);
+            WriteBatch(previous, p_inflight);
+
+            p_inflight = count;
+            p_fill = previous;
+            p_current = 0;
+
+            if (flush) {
+                Wait();
+                WriteBatch(p_batch - p_fill, p_inflight);
+                p_inflight = 0;
+            }
+
+            return !p_failed;
+        }
+
+    private:
+        streamT<size_t>         &p_destination;
+        size_t                   p_blocksize;
+        size_t                   p_batch;     // blocks compressed at once
+        std::vector<Block>       p_blocks;    // one batch, or two for parallel writer
+        size_t                   p_fill;      // first block of batch which is being filled
+        size_t                   p_current;   // block of batch which is being filled
+        size_t                   p_inflight;  // blocks of other batch given to workers
+        std::vector<std::thread> p_workers;
+        std::mutex               p_lock;
+        std::condition_variable  p_queuedsignal;
+        std::condition_variable  p_donesignal;
+        size_t                   p_next;      // next block for workers
+        size_t                   p_end;
+        size_t                   p_remaining; // dispatched blocks not compressed yet
+        size_t                   p_position;
+        bool                     p_finished;
+        bool                     p_failed;
+        bool                     p_stop;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     CompressedReader
+     -------------------------------------------------------------------------------
+         decompressing read filter around any streamT<size_t>
+
+         reads compressed data written by CompressedWriter block by block,
+         reading stops at end mark or at the end of source stream
+
+         mode of reader is StreamRead, position() is amount of uncompressed
+         data read
+
+         malformed data stops reading and sets corrupted() flag
+    */
+
+    class CompressedReader : public Stream
+    {
+    public:
+        CompressedReader(streamT<size_t> &source) :
+            p_source(source),
+            p_raw(nullptr),
+            p_packed(nullptr),
+            p_rawcapacity(0),
+            p_packedcapacity(0),
+            p_current(0),
+            p_end(0),
+            p_position(0),
+            p_finished(false),
+            p_corrupted(false)
+        {}
+
+        CompressedReader(const CompressedReader &) = delete;
+        CompressedReader &operator=(const CompressedReader &) = delete;
+
+        ~CompressedReader() override
+        {
+            delete[] p_raw;
+            delete[] p_packed;
+        }
+
+        streamT<size_t> &source() const { return p_source; }
+
+        bool corrupted() const { return p_corrupted; }
+
+        // streamT interface
+        size_t read(void *to, size_t size) override
+        {
+            auto dest = static_cast<unsigned char*>(to);
+            auto total = size_t(0);
+
+            while (total < size) {
+                if (p_current == p_end && !NextBlock()) {
+                    break;
+                }
+
+                auto amount = c_util::umin(size - total, p_end - p_current);
+                memcpy(dest + total, p_raw + p_current, amount);
+                p_current += amount;
+                total += amount;
+            }
+
+            p_position += total;
+            return total;
+        }
+
+        size_t write(const void *, size_t) override
+        {
+            return 0;
+        }
+
+        size_t seek(size_t, SeekOrigin = SeekOrigin::Begin) override
+        {
+            return 0;
+        }
+
+        StreamMode mode() const override { return StreamMode::StreamRead; }
+        size_t position() const override { return p_position; }
+        size_t size() const override { return p_position + (p_end - p_current); }
+
+    private:
+        static size_t GetU32(const unsigned char *from)
+        {
+            return size_t(from[0]) | (size_t(from[1]) << 8) | (size_t(from[2]) << 16) | (size_t(from[3]) << 24);
+        }
+
+        static void Ensure(unsigned char *&buffer, size_t &capacity, size_t size)
+        {
+            if (size > capacity) {
+                delete[] buffer;
+                buffer = new unsigned char[size];
+                capacity = size;
+            }
+        }
+
+        // reads until size or source end, source could return less before
+        // its end (like pipe does)
+        size_t ReadSource(unsigned char *to, size_t size)
+        {
+            auto total = size_t(0);
+            while (total < size) {
+                auto amount = p_source.read(to + total, size - total);
+                if (amount == 0) {
+                    break;
+                }
+                total += amount;
+            }
+            return total;
+        }
+
+        bool Fail()
+        {
+            p_corrupted = true;
+            p_finished = true;
+            return false;
+        }
+
+        bool NextBlock()
+        {
+            if (p_finished) {
+                return false;
+            }
+
+            unsigned char header[COMPRESSED_BLOCK_HEADER];
+            auto amount = ReadSource(header, sizeof(header));
+            if (amount == 0) {
+                p_finished = true;
+                return false;
+            }
+
+            if (amount != sizeof(header)) {
+                return Fail();
+            }
+
+            auto rawsize = GetU32(header);
+            auto packedsize = GetU32(header + 4);
+
+            if (rawsize == 0) {
+                p_finished = true;
+                return false;
+            }
+
+            if (rawsize > COMPRESSED_MAX_BLOCK || packedsize > rawsize) {
+                return Fail();
+            }
+
+            Ensure(p_raw, p_rawcapacity, rawsize);
+
+            if (packedsize == rawsize) {
+                if (ReadSource(p_raw, rawsize) != rawsize) {
+                    return Fail();
+                }
+            } else {
+                Ensure(p_packed, p_packedcapacity, packedsize);
+                if (ReadSource(p_packed, packedsize) != packedsize ||
+                    !LZBlockCodec::Decompress(p_packed, packedsize, p_raw, rawsize)) {
+                    return Fail();
+                }
+            }
+
+            p_current = 0;
+            p_end = rawsize;
+
+            return true;
+        }
+
+    private:
+        streamT<size_t> &p_source;
+        unsigned char   *p_raw;
+        unsigned char   *p_packed;
+        size_t           p_rawcapacity;
+        size_t           p_packedcapacity;
+        size_t           p_current;  // read position inside decompressed block
+        size_t           p_end;      // size of decompressed block
+        size_t           p_position;
+        bool             p_finished;
+        bool             p_corrupted;
+    };
+}
@@ -0,0 +1,602 @@
+/*
+        file stream implementations (POSIX)
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include "c_stringview.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     FileStream
+     -------------------------------------------------------------------------------
+         file stream on top of pread()/pwrite() system calls
+
+         supported modes:
+            Read      - existing file is opened read only
+            ReadWrite - file is opened for reading and writing, it's created
+                        if it doesn't exist
+
+         position and size are tracked by stream itself and all transfers are
+         done at explicit offset, so position(), size() and seek() don't cost
+         system calls, file should not be modified by other means while
+         stream is open
+
+         readat()/writeat() map directly to pread()/pwrite() and are thread safe
+
+         readv()/writev() transfer all buffers with single preadv()/pwritev()
+         call (per IOV_BATCH buffers)
+    */
+
+    class FileStream : public Stream
+    {
+    public:
+        enum
+        {
+            IOV_BATCH = 64 // max buffers passed to single vectored call
+        };
+
+    public:
+        FileStream() noexcept :
+            p_handle(-1),
+            p_mode(StreamMode::Closed),
+            p_position(0),
+            p_size(0)
+        {}
+
+        FileStream(const char *path, StreamMode mode = StreamMode::Read) noexcept :
+            FileStream()
+        {
+            Open(path, mode);
+        }
+
+        FileStream(const FileStream &) = delete;
+        FileStream &operator=(const FileStream &) = delete;
+
+        ~FileStream() override
+        {
+            Close();
+        }
+
+        bool Open(const char *path, StreamMode mode = StreamMode::Read) noexcept
+        {
+            Close();
+
+            int flags;
+            switch (mode) {
+                case StreamMode::Read:      flags = O_RDONLY; break;
+                case StreamMode::ReadWrite: flags = O_RDWR | O_CREAT; break;
+                default: return false;
+            }
+
+            auto handle = ::open(path, flags | O_CLOEXEC, 0644);
+            if (handle < 0) {
+                return false;
+            }
+
+            struct stat st;
+            if (fstat(handle, &st) != 0) {
+                ::close(handle);
+                return false;
+            }
+
+            p_handle = handle;
+            p_mode = mode;
+            p_position = 0;
+            p_size = size_t(st.st_size);
+
+            return true;
+        }
+
+        void Close() noexcept
+        {
+            if (p_handle >= 0) {
+                ::close(p_handle);
+            }
+
+            p_handle = -1;
+            p_mode = StreamMode::Closed;
+            p_position = 0;
+            p_size = 0;
+        }
+
+        // underlying file descriptor, -1 if stream is closed
+        int handle() const noexcept { return p_handle; }
+
+        // moves position forward over data transferred directly through
+        // handle() (splice(), copy_file_range() and so on), size grows if
+        // position goes past the end
+        void Advance(size_t amount) noexcept
+        {
+            p_position += amount;
+            p_size = c_util::umax(p_size, p_position);
+        }
+
+        // streamT interface
+        size_t read(void *to, size_t size) override
+        {
+            auto amount = readat(to, size, p_position);
+            p_position += amount;
+            return amount;
+        }
+
+        size_t write(const void *from, size_t size) override
+        {
+            auto amount = writeat(from, size, p_position);
+            p_position += amount;
+            return amount;
+        }
+
+        size_t seek(size_t newpos, SeekOrigin origin = SeekOrigin::Begin) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            p_position = seekposition(newpos, origin, p_position, p_size);
+            return p_position;
+        }
+
+        StreamMode mode() const override { return p_mode; }
+        size_t position() const override { return p_position; }
+        size_t size() const override { return p_size; }
+
+        size_t readv(const Span<MutableSpan<unsigned char>> &buffers) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            return Transfer(buffers.data(), buffers.size(), false);
+        }
+
+        size_t writev(const Span<Span<unsigned char>> &buffers) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto total = Transfer(buffers.data(), buffers.size(), true);
+            p_size = c_util::umax(p_size, p_position);
+
+            return total;
+        }
+
+        size_t readat(void *to, size_t size, size_t offset) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            auto dest = static_cast<char*>(to);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto amount = ::pread(p_handle, dest + total, size - total, off_t(offset + total));
+                if (amount <= 0) {
+                    if (amount < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                total += size_t(amount);
+            }
+
+            return total;
+        }
+
+        size_t writeat(const void *from, size_t size, size_t offset) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto source = static_cast<const char*>(from);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto amount = ::pwrite(p_handle, source + total, size - total, off_t(offset + total));
+                if (amount <= 0) {
+                    if (amount < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                total += size_t(amount);
+            }
+
+            if ((offset + total) > p_size) {
+                p_size = offset + total;
+            }
+
+            return total;
+        }
+
+    protected:
+        // vectored transfer at current position, stops at first short transfer
+        template <typename B>
+        size_t Transfer(const B *buffers, size_t count, bool write)
+        {
+            iovec vectors[IOV_BATCH];
+            auto total = size_t(0);
+
+            while (count > 0) {
+                auto batch = c_util::umin(count, size_t(IOV_BATCH));
+                auto requested = size_t(0);
+
+                for (auto n = size_t(0); n < batch; ++n) {
+                    vectors[n].iov_base = const_cast<unsigned char*>(buffers[n].data());
+                    vectors[n].iov_len = buffers[n].size();
+                    requested += buffers[n].size();
+                }
+
+                auto amount = write ?
+                    ::pwritev(p_handle, vectors, int(batch), off_t(p_position)) :
+                    ::preadv(p_handle, vectors, int(batch), off_t(p_position));
+
+                if (amount < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+
+                p_position += size_t(amount);
+                total += size_t(amount);
+
+                if (size_t(amount) < requested) {
+                    break;
+                }
+
+                buffers += batch;
+                count -= batch;
+            }
+
+            return total;
+        }
+
+    protected:
+        int        p_handle;
+        StreamMode p_mode;
+        size_t     p_position;
+        size_t     p_size;
+    };
+
+
+    // expected access pattern hint for mapped data
+    enum class MappedAccess
+    {
+        Normal,     // no special treatment
+        Sequential, // aggressive read ahead, pages could be freed soon after access
+        Random,     // no read ahead
+        WillNeed,   // start reading pages in advance
+        DontNeed    // pages won't be accessed in near future
+    };
+
+    /*
+     -------------------------------------------------------------------------------
+     MappedFileStream
+     -------------------------------------------------------------------------------
+         file stream on top of memory mapped file
+
+         supported modes:
+            Read      - existing file is mapped read only
+            ReadWrite - file is mapped for reading and writing, it's created
+                        if it doesn't exist, writing beyond the end expands
+                        file (space is reserved geometrically, file is
+                        truncated to actual size on Close())
+
+         read()/write() are plain memory copies, data() and text() give
+         direct access to the whole mapped file, so parsers can work on file
+         contents without reading it into separate buffer
+
+         any write which expands file could move mapping to other address,
+         pointers and views obtained before such write become invalid
+    */
+
+    class MappedFileStream : public Stream
+    {
+    public:
+        MappedFileStream() noexcept :
+            p_handle(-1),
+            p_mode(StreamMode::Closed),
+            p_data(nullptr),
+            p_capacity(0),
+            p_position(0),
+            p_size(0)
+        {}
+
+        MappedFileStream(const char *path, StreamMode mode = StreamMode::Read) noexcept :
+            MappedFileStream()
+        {
+            Open(path, mode);
+        }
+
+        MappedFileStream(const MappedFileStream &) = delete;
+        MappedFileStream &operator=(const MappedFileStream &) = delete;
+
+        ~MappedFileStream() override
+        {
+            Close();
+        }
+
+        bool Open(const char *path, StreamMode mode = StreamMode::Read) noexcept
+        {
+            Close();
+
+            int flags;
+            switch (mode) {
+                case StreamMode::Read:      flags = O_RDONLY; break;
+                case StreamMode::ReadWrite: flags = O_RDWR | O_CREAT; break;
+                default: return false;
+            }
+
+            auto handle = ::open(path, flags | O_CLOEXEC, 0644);
+            if (handle < 0) {
+                return false;
+            }
+
+            struct stat st;
+            if (fstat(handle, &st) != 0) {
+                ::close(handle);
+                return false;
+            }
+
+            p_handle = handle;
+            p_mode = mode;
+            p_size = size_t(st.st_size);
+
+            if (p_size > 0 && !Map(p_size)) {
+                Close();
+                return false;
+            }
+
+            return true;
+        }
+
+        void Close() noexcept
+        {
+            if (p_data) {
+                munmap(p_data, p_capacity);
+            }
+
+            if (p_handle >= 0) {
+                // drop space reserved by writes
+                if (p_mode == StreamMode::ReadWrite && p_capacity > p_size) {
+                    auto result = ftruncate(p_handle, off_t(p_size));
+                    (void)result;
+                }
+                ::close(p_handle);
+            }
+
+            p_handle = -1;
+            p_mode = StreamMode::Closed;
+            p_data = nullptr;
+            p_capacity = 0;
+            p_position = 0;
+            p_size = 0;
+        }
+
+        // writes modified pages to the file
+        bool Flush() noexcept
+        {
+            return p_data == nullptr || msync(p_data, p_capacity, MS_SYNC) == 0;
+        }
+
+        // hints kernel on how mapped data is going to be accessed
+        bool advise(MappedAccess access) noexcept
+        {
+            return advise(access, 0, p_capacity);
+        }
+
+        bool advise(MappedAccess access, size_t offset, size_t size) noexcept
+        {
+            if (p_data == nullptr || offset >= p_capacity) {
+                return false;
+            }
+
+            // madvise wants page aligned address
+            auto pagesize = size_t(sysconf(_SC_PAGESIZE));
+            auto start = offset & ~(pagesize - 1);
+            size = c_util::umin(size + (offset - start), p_capacity - start);
+
+            int advice;
+            switch (access) {
+                case MappedAccess::Sequential: advice = MADV_SEQUENTIAL; break;
+                case MappedAccess::Random:     advice = MADV_RANDOM; break;
+                case MappedAccess::WillNeed:   advice = MADV_WILLNEED; break;
+                case MappedAccess::DontNeed:   advice = MADV_DONTNEED; break;
+                default:                       advice = MADV_NORMAL; break;
+            }
+
+            return madvise(p_data + start, size, advice) == 0;
+        }
+
+        // whole file contents
+        Span<unsigned char> data() const noexcept { return Span<unsigned char>(p_data, p_size); }
+        StringView text() const noexcept { return StringView(reinterpret_cast<const char*>(p_data), p_size); }
+
+        // file contents starting from current position
+        Span<unsigned char> remaining() const noexcept { return data().slice(p_position); }
+
+        int handle() const noexcept { return p_handle; }
+
+        // streamT interface
+        size_t read(void *to, size_t size) override
+        {
+            auto amount = readat(to, size, p_position);
+            p_position += amount;
+            return amount;
+        }
+
+        size_t write(const void *from, size_t size) override
+        {
+            auto amount = writeat(from, size, p_position);
+            p_position += amount;
+            return amount;
+        }
+
+        size_t seek(size_t newpos, SeekOrigin origin = SeekOrigin::Begin) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            p_position = seekposition(newpos, origin, p_position, p_size);
+            return p_position;
+        }
+
+        StreamMode mode() const override { return p_mode; }
+        size_t position() const override { return p_position; }
+        size_t size() const override { return p_size; }
+
+        size_t readv(const Span<MutableSpan<unsigned char>> &buffers) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            auto total = size_t(0);
+            for (auto &buffer : buffers) {
+                auto amount = adjustread(buffer.size(), p_position, p_size);
+                memcpy(buffer.data(), p_data + p_position, amount);
+                p_position += amount;
+                total += amount;
+
+                if (amount < buffer.size()) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        size_t writev(const Span<Span<unsigned char>> &buffers) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            // expand file once for all buffers
+            auto total = size_t(0);
+            for (auto &buffer : buffers) {
+                total += buffer.size();
+            }
+
+            auto end = p_position + total;
+            if (end > p_capacity && !Reserve(end)) {
+                return 0;
+            }
+
+            for (auto &buffer : buffers) {
+                memcpy(p_data + p_position, buffer.data(), buffer.size());
+                p_position += buffer.size();
+            }
+
+            p_size = c_util::umax(p_size, end);
+
+            return total;
+        }
+
+        size_t readat(void *to, size_t size, size_t offset) override
+        {
+            if (p_mode == StreamMode::Closed || offset >= p_size) {
+                return 0;
+            }
+
+            size = adjustread(size, offset, p_size);
+            memcpy(to, p_data + offset, size);
+
+            return size;
+        }
+
+        size_t writeat(const void *from, size_t size, size_t offset) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto end = offset + size;
+            if (end > p_capacity && !Reserve(end)) {
+                return 0;
+            }
+
+            memcpy(p_data + offset, from, size);
+            if (end > p_size) {
+                p_size = end;
+            }
+
+            return size;
+        }
+
+    protected:
+        bool Map(size_t capacity) noexcept
+        {
+            auto protection = p_mode == StreamMode::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+            auto data = mmap(nullptr, capacity, protection, MAP_SHARED, p_handle, 0);
+            if (data == MAP_FAILED) {
+                return false;
+            }
+
+            p_data = static_cast<unsigned char*>(data);
+            p_capacity = capacity;
+
+            return true;
+        }
+
+        bool Reserve(size_t size) noexcept
+        {
+            auto newcapacity = c_util::umax(p_capacity + p_capacity / 2, size);
+            newcapacity = c_util::align(newcapacity, size_t(sysconf(_SC_PAGESIZE)));
+
+            if (ftruncate(p_handle, off_t(newcapacity)) != 0) {
+                return false;
+            }
+
+            if (p_data == nullptr) {
+                return Map(newcapacity);
+            }
+
+#if defined(__linux__)
+            auto data = mremap(p_data, p_capacity, newcapacity, MREMAP_MAYMOVE);
+            if (data == MAP_FAILED) {
+                return false;
+            }
+
+            p_data = static_cast<unsigned char*>(data);
+            p_capacity = newcapacity;
+
+            return true;
+#else
+            munmap(p_data, p_capacity);
+            p_data = nullptr;
+            return Map(newcapacity);
+#endif
+        }
+
+    protected:
+        int            p_handle;
+        StreamMode     p_mode;
+        unsigned char *p_data;
+        size_t         p_capacity; // mapped size, could be larger than file size after writes
+        size_t         p_position;
+        size_t         p_size;
+    };
+}
@@ -0,0 +1,332 @@
+/*
+        intrusive hash table
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_util.h"
+#include "c_stringview.h"
+#include <functional>
+
+
+namespace c_common
+{
+    template <typename T, typename K>
+    class IntrusiveHashDefaultAdapter
+    {
+    public:
+        static T * &next(T *item) { return item->hashnext; }
+        static size_t &hashvalue(T *item) { return item->hashvalue; }
+        static const K &key(const T *item) { return item->hashkey; }
+        static size_t hash(const K &key) { return std::hash<K>()(key); }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     IntrusiveHash<T, K, intrusiveT>
+     -------------------------------------------------------------------------------
+         hash table of items with unique keys, buckets are chained through
+         links embedded into items, so inserting and removing items doesn't
+         allocate memory (only bucket array is allocated when table grows)
+
+            struct Node : IntrusiveList<Node>::Links, IntrusiveHash<Node>::Links
+            {
+                StringView hashkey;
+                ...
+            };
+
+            IntrusiveHash<Node> index;
+            index.Insert(node);
+            auto found = index.Find("name"_sv);
+
+         when table gets full (more items than buckets) it's rehashed to
+         table with twice more buckets incrementally, every following
+         Insert() or Remove() moves few buckets to new table, so there's
+         no long stop to rehash whole table, both tables are searched
+         while rehash is in progress
+
+         item hash is kept in its links, keys aren't hashed again on rehash,
+         key returned by intrusiveT must stay unchanged while item is in table
+
+         like IntrusiveList, table doesn't own items
+    */
+
+    template <typename T, typename K = StringView, typename intrusiveT = IntrusiveHashDefaultAdapter<T, K>>
+    class IntrusiveHash
+    {
+    public:
+        enum
+        {
+            MIN_BUCKETS = 16,
+            REHASH_STEP = 4  // buckets moved to new table by single call
+        };
+
+        struct Links
+        {
+            Links() :
+                hashnext(nullptr),
+                hashvalue(0)
+            {}
+
+            T      *hashnext;
+            size_t  hashvalue;
+        };
+
+    public:
+        IntrusiveHash() :
+            p_rehash(0)
+        {}
+
+        IntrusiveHash(const IntrusiveHash &) = delete;
+        IntrusiveHash &operator=(const IntrusiveHash &) = delete;
+
+        ~IntrusiveHash()
+        {
+            Clear();
+        }
+
+        size_t size() const { return p_tables[0].count + p_tables[1].count; }
+        size_t buckets() const { return Buckets(p_tables[0]) + Buckets(p_tables[1]); }
+        bool rehashing() const { return p_tables[1].buckets != nullptr; }
+
+        T *Find(const K &key) const
+        {
+            return Lookup(key, hashof(key));
+        }
+
+        // inserts item, if there's item with the same key already, new item
+        // isn't inserted and existing item is returned
+        T *Insert(T *item)
+        {
+            auto &key = intrusiveT::key(item);
+            auto hash = hashof(key);
+
+            if (auto existing = Lookup(key, hash)) {
+                return existing;
+            }
+
+            Grow();
+
+            intrusiveT::hashvalue(item) = hash;
+            Link(p_tables[rehashing() ? 1 : 0], item);
+
+            return nullptr;
+        }
+
+        // removes item by key, returns removed item or nullptr
+        T *Remove(const K &key)
+        {
+            auto hash = hashof(key);
+
+            for (auto &table : p_tables) {
+                if (table.buckets == nullptr) {
+                    continue;
+                }
+
+                for (auto link = &table.buckets[hash & table.mask]; *link; link = &intrusiveT::next(*link)) {
+                    auto item = *link;
+                    if (intrusiveT::hashvalue(item) == hash && intrusiveT::key(item) == key) {
+                        Unlink(table, link);
+                        Step();
+                        return item;
+                    }
+                }
+            }
+
+            return nullptr;
+        }
+
+        // removes item, returns false if item isn't in table
+        bool Remove(T *item)
+        {
+            auto hash = intrusiveT::hashvalue(item);
+
+            for (auto &table : p_tables) {
+                if (table.buckets == nullptr) {
+                    continue;
+                }
+
+                for (auto link = &table.buckets[hash & table.mask]; *link; link = &intrusiveT::next(*link)) {
+                    if (*link == item) {
+                        Unlink(table, link);
+                        Step();
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        // makes room for count items without further rehash, finishes
+        // incremental rehash and rehashes whole table at once if needed
+        void Reserve(size_t count)
+        {
+            while (rehashing()) {
+                Step();
+            }
+
+            auto buckets = size_t(MIN_BUCKETS);
+            while (buckets < count) {
+                buckets *= 2;
+            }
+
+            if (buckets > Buckets(p_tables[0])) {
+                Allocate(p_tables[1], buckets);
+                p_rehash = 0;
+                Move(Buckets(p_tables[0]));
+            }
+        }
+
+        // calls f(T*) for every item, table must not be changed by f
+        template <typename F>
+        void ForEach(F f) const
+        {
+            for (auto &table : p_tables) {
+                for (auto n = size_t(0); n < Buckets(table); ++n) {
+                    for (auto item = table.buckets[n]; item; item = intrusiveT::next(item)) {
+                        f(item);
+                    }
+                }
+            }
+        }
+
+        // detaches all items and frees buckets
+        void Clear()
+        {
+            for (auto &table : p_tables) {
+                for (auto n = size_t(0); n < Buckets(table); ++n) {
+                    auto item = table.buckets[n];
+                    while (item) {
+                        auto next = intrusiveT::next(item);
+                        intrusiveT::next(item) = nullptr;
+                        item = next;
+                    }
+                }
+
+                delete[] table.buckets;
+                table = Table();
+            }
+
+            p_rehash = 0;
+        }
+
+    private:
+        struct Table
+        {
+            T      **buckets = nullptr;
+            size_t   mask = 0;
+            size_t   count = 0;
+        };
+
+        static size_t hashof(const K &key)
+        {
+            return c_util::hashmix(intrusiveT::hash(key));
+        }
+
+        static size_t Buckets(const Table &table)
+        {
+            return table.buckets ? table.mask + 1 : 0;
+        }
+
+        static void Allocate(Table &table, size_t buckets)
+        {
+            table.buckets = new T*[buckets]();
+            table.mask = buckets - 1;
+            table.count = 0;
+        }
+
+        static void Link(Table &table, T *item)
+        {
+            auto &bucket = table.buckets[intrusiveT::hashvalue(item) & table.mask];
+            intrusiveT::next(item) = bucket;
+            bucket = item;
+            ++table.count;
+        }
+
+        static void Unlink(Table &table, T **link)
+        {
+            auto item = *link;
+            *link = intrusiveT::next(item);
+            intrusiveT::next(item) = nullptr;
+            --table.count;
+        }
+
+        T *Lookup(const K &key, size_t hash) const
+        {
+            for (auto &table : p_tables) {
+                if (table.buckets == nullptr) {
+                    continue;
+                }
+
+                for (auto item = table.buckets[hash & table.mask]; item; item = intrusiveT::next(item)) {
+                    if (intrusiveT::hashvalue(item) == hash && intrusiveT::key(item) == key) {
+                        return item;
+                    }
+                }
+            }
+
+            return nullptr;
+        }
+
+        // prepares room for one more item
+        void Grow()
+        {
+            if (p_tables[0].buckets == nullptr) {
+                Allocate(p_tables[0], MIN_BUCKETS);
+                return;
+            }
+
+            if (!rehashing() && p_tables[0].count >= Buckets(p_tables[0])) {
+                Allocate(p_tables[1], Buckets(p_tables[0]) * 2);
+                p_rehash = 0;
+            }
+
+            Step();
+        }
+
+        // continues incremental rehash
+        void Step()
+        {
+            if (rehashing()) {
+                Move(REHASH_STEP);
+            }
+        }
+
+        // moves up to count buckets from old table to new one
+        void Move(size_t count)
+        {
+            auto &from = p_tables[0];
+            auto &to = p_tables[1];
+
+            for (auto n = size_t(0); n < count && p_rehash < Buckets(from); ++n, ++p_rehash) {
+                auto item = from.buckets[p_rehash];
+                while (item) {
+                    auto next = intrusiveT::next(item);
+                    Link(to, item);
+                    item = next;
+                    --from.count;
+                }
+                from.buckets[p_rehash] = nullptr;
+            }
+
+            if (p_rehash == Buckets(from)) {
+                delete[] from.buckets;
+                from = to;
+                to = Table();
+                p_rehash = 0;
+            }
+        }
+
+    private:
+        Table  p_tables[2]; // current table and new one while rehashing
+        size_t p_rehash;    // next bucket of current table to be moved
+    };
+}
@@ -0,0 +1,242 @@
+/*
+        intrusive pairing heap
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+
+namespace c_common
+{
+    template <typename T>
+    class IntrusiveHeapDefaultAdapter
+    {
+    public:
+        static T * &child(T *item) { return item->heapchild; }
+        static T * &next(T *item) { return item->heapnext; }
+        static T * &prev(T *item) { return item->heapprev; }
+
+        static bool less(const T *a, const T *b) { return *a < *b; }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     IntrusiveHeap<T, intrusiveT>
+     -------------------------------------------------------------------------------
+         priority queue of items which carry heap links (pairing heap)
+
+            struct Job : IntrusiveHeap<Job>::Links
+            {
+                int priority;
+                bool operator<(const Job &other) const { return priority > other.priority; }
+            };
+
+            IntrusiveHeap<Job> jobs;
+            jobs.Insert(job);
+            auto next = jobs.PopFront();
+
+         front() is the smallest item by intrusiveT::less(), Insert() is O(1),
+         PopFront() and Remove() of any item are O(log n) amortized, after
+         item key was changed Update() puts item to its new place
+
+         order of items with equal keys isn't defined, use IntrusiveTree if
+         insertion order of equal items matters
+
+         like IntrusiveList, heap does not own items and doesn't allocate
+         memory
+    */
+
+    template <typename T, typename intrusiveT = IntrusiveHeapDefaultAdapter<T>>
+    class IntrusiveHeap
+    {
+    public:
+        IntrusiveHeap() :
+            p_root(nullptr),
+            p_count(0)
+        {}
+
+        IntrusiveHeap(const IntrusiveHeap &) = delete;
+        IntrusiveHeap &operator=(const IntrusiveHeap &) = delete;
+
+        T *front() const noexcept { return p_root; }
+        size_t size() const noexcept { return p_count; }
+
+        void Insert(T *item)
+        {
+            intrusiveT::child(item) = nullptr;
+            intrusiveT::next(item) = nullptr;
+            intrusiveT::prev(item) = nullptr;
+
+            p_root = p_root ? Meld(p_root, item) : item;
+            ++p_count;
+        }
+
+        // removes and returns smallest item, nullptr if heap is empty
+        T *PopFront()
+        {
+            auto item = p_root;
+            if (item) {
+                p_root = MergePairs(intrusiveT::child(item));
+                intrusiveT::child(item) = nullptr;
+                --p_count;
+            }
+            return item;
+        }
+
+        void Remove(T *item)
+        {
+            if (item == p_root) {
+                PopFront();
+                return;
+            }
+
+            // prev is parent for first child and previous sibling for others
+            auto prev = intrusiveT::prev(item);
+            auto next = intrusiveT::next(item);
+
+            if (intrusiveT::child(prev) == item) {
+                intrusiveT::child(prev) = next;
+            } else {
+                intrusiveT::next(prev) = next;
+            }
+
+            if (next) {
+                intrusiveT::prev(next) = prev;
+            }
+
+            intrusiveT::next(item) = nullptr;
+            intrusiveT::prev(item) = nullptr;
+
+            auto subheap = MergePairs(intrusiveT::child(item));
+            intrusiveT::child(item) = nullptr;
+
+            if (subheap) {
+                p_root = Meld(p_root, subheap);
+            }
+
+            --p_count;
+        }
+
+        // repositions item after its key was changed
+        void Update(T *item)
+        {
+            Remove(item);
+            Insert(item);
+        }
+
+        // detaches all items
+        void Clear()
+        {
+            // depth first walk, links are cleared on the way, prev link
+            // leads back to parent or previous sibling
+            auto item = p_root;
+            while (item) {
+                if (auto child = intrusiveT::child(item)) {
+                    intrusiveT::child(item) = nullptr;
+                    item = child;
+                } else if (auto next = intrusiveT::next(item)) {
+                    intrusiveT::next(item) = nullptr;
+                    item = next;
+                } else {
+                    auto prev = intrusiveT::prev(item);
+                    intrusiveT::prev(item) = nullptr;
+                    item = prev;
+                }
+            }
+
+            p_root = nullptr;
+            p_count = 0;
+        }
+
+    public:
+        struct Links
+        {
+            Links() :
+                heapchild(nullptr),
+                heapnext(nullptr),
+                heapprev(nullptr)
+            {}
+
+            T *heapchild;
+            T *heapnext;
+            T *heapprev;
+        };
+
+    private:
+        // joins two detached heaps, returns new root
+        static T *Meld(T *a, T *b)
+        {
+            if (intrusiveT::less(b, a)) {
+                auto t = a;
+                a = b;
+                b = t;
+            }
+
+            // b becomes first child of a
+            auto child = intrusiveT::child(a);
+            intrusiveT::next(b) = child;
+            if (child) {
+                intrusiveT::prev(child) = b;
+            }
+            intrusiveT::prev(b) = a;
+            intrusiveT::child(a) = b;
+
+            return a;
+        }
+
+        // merges list of sibling heaps into single heap (two pass)
+        static T *MergePairs(T *first)
+        {
+            if (first == nullptr) {
+                return nullptr;
+            }
+
+            // first pass: meld pairs left to right, results are collected
+            // into list in reverse order
+            T *pairs = nullptr;
+            while (first) {
+                auto a = first;
+                auto b = intrusiveT::next(a);
+
+                intrusiveT::prev(a) = nullptr;
+                intrusiveT::next(a) = nullptr;
+
+                if (b == nullptr) {
+                    first = nullptr;
+                } else {
+                    first = intrusiveT::next(b);
+                    intrusiveT::prev(b) = nullptr;
+                    intrusiveT::next(b) = nullptr;
+                    a = Meld(a, b);
+                }
+
+                intrusiveT::next(a) = pairs;
+                pairs = a;
+            }
+
+            // second pass: meld results right to left
+            auto result = pairs;
+            pairs = intrusiveT::next(pairs);
+            intrusiveT::next(result) = nullptr;
+
+            while (pairs) {
+                auto next = intrusiveT::next(pairs);
+                intrusiveT::next(pairs) = nullptr;
+                result = Meld(result, pairs);
+                pairs = next;
+            }
+
+            return result;
+        }
+
+    private:
+        T      *p_root;
+        size_t  p_count;
+    };
+}
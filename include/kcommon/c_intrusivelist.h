@@ -50,7 +50,7 @@ namespace c_common
 
             ForwardIterator &operator++()
             {
-                p_current = intrusiveT::next(p_current);
+                this->p_current = intrusiveT::next(this->p_current);
                 return *this;
             }
         };
@@ -68,7 +68,7 @@ namespace c_common
 
             BackwardIterator &operator++()
             {
-                p_current = intrusiveT::prev(p_current);
+                this->p_current = intrusiveT::prev(this->p_current);
                 return *this;
             }
         };
@@ -83,7 +83,7 @@ namespace c_common
         IntrusiveList(const IntrusiveList &source) = delete;
         IntrusiveList &operator=(const IntrusiveList &source) = delete;
 
-        IntrusiveList(const IntrusiveList &&source) :
+        IntrusiveList(IntrusiveList &&source) noexcept :
             p_firstchild(source.p_firstchild),
             p_lastchild(source.p_lastchild),
             p_count(source.p_count)
@@ -177,6 +177,203 @@ namespace c_common
 #endif
         }
 
+        void PushFront(T *item)
+        {
+            if (p_firstchild == nullptr) {
+                Add(item);
+                return;
+            }
+
+            intrusiveT::next(item) = p_firstchild;
+            intrusiveT::prev(p_firstchild) = item;
+            p_firstchild = item;
+
+            ++p_count;
+        }
+
+        // where must be item of this list
+        void InsertBefore(T *where, T *item)
+        {
+            auto prev = intrusiveT::prev(where);
+            if (prev) {
+                InsertAfter(prev, item);
+            } else {
+                PushFront(item);
+            }
+        }
+
+        // where must be item of this list
+        void InsertAfter(T *where, T *item)
+        {
+            auto next = intrusiveT::next(where);
+            if (next == nullptr) {
+                Add(item);
+                return;
+            }
+
+            intrusiveT::prev(item) = where;
+            intrusiveT::next(item) = next;
+            intrusiveT::next(where) = item;
+            intrusiveT::prev(next) = item;
+
+            ++p_count;
+        }
+
+        // moves all items of other list to the end of this list
+        void Splice(IntrusiveList &other)
+        {
+            Splice(nullptr, other);
+        }
+
+        // moves all items of other list before where (nullptr means end)
+        void Splice(T *where, IntrusiveList &other)
+        {
+            if (&other == this || other.p_count == 0) {
+                return;
+            }
+
+            Link(where, other.p_firstchild, other.p_lastchild);
+            p_count += other.p_count;
+
+            other.p_firstchild = nullptr;
+            other.p_lastchild = nullptr;
+            other.p_count = 0;
+        }
+
+        // moves items from first to last (inclusive) of other list before
+        // where, count is number of moved items, other could be this list
+        // if where is outside of moved range
+        void Splice(T *where, IntrusiveList &other, T *first, T *last, size_t count)
+        {
+            other.Unlink(first, last);
+            other.p_count -= count;
+
+            Link(where, first, last);
+            p_count += count;
+        }
+
+        // same as above, counts moved items
+        void Splice(T *where, IntrusiveList &other, T *first, T *last)
+        {
+            auto count = size_t(1);
+            for (auto item = first; item != last; item = intrusiveT::next(item)) {
+                ++count;
+            }
+
+            Splice(where, other, first, last, count);
+        }
+
+        // stable merge sort, less(a, b) returns true if item a goes before
+        // item b, items are relinked in place without allocation
+        template <typename L>
+        void Sort(L less)
+        {
+            if (p_count < 2) {
+                return;
+            }
+
+            // bottom up merge of runs of width items, only next links are
+            // maintained during merge
+            auto list = p_firstchild;
+            for (auto width = size_t(1); ; width *= 2) {
+                T  *result = nullptr;
+                T **tail = &result;
+                auto merges = size_t(0);
+
+                auto left = list;
+                while (left) {
+                    ++merges;
+
+                    auto right = left;
+                    auto leftsize = size_t(0);
+                    while (leftsize < width && right) {
+                        ++leftsize;
+                        right = intrusiveT::next(right);
+                    }
+                    auto rightsize = width;
+
+                    while (leftsize > 0 || (rightsize > 0 && right)) {
+                        T *item;
+                        if (leftsize == 0 || (rightsize > 0 && right && less(right, left))) {
+                            item = right;
+                            right = intrusiveT::next(right);
+                            --rightsize;
+                        } else {
+                            item = left;
+                            left = intrusiveT::next(left);
+                            --leftsize;
+                        }
+
+                        *tail = item;
+                        tail = &intrusiveT::next(item);
+                    }
+
+                    left = right;
+                }
+
+                *tail = nullptr;
+                list = result;
+
+                if (merges <= 1) {
+                    break;
+                }
+            }
+
+            // restore prev links
+            T *prev = nullptr;
+            for (auto item = list; item; item = intrusiveT::next(item)) {
+                intrusiveT::prev(item) = prev;
+                prev = item;
+            }
+
+            p_firstchild = list;
+            p_lastchild = prev;
+        }
+
+    private:
+        // detaches chain of items from first to last, doesn't change count
+        void Unlink(T *first, T *last)
+        {
+            auto prev = intrusiveT::prev(first);
+            auto next = intrusiveT::next(last);
+
+            if (prev) {
+                intrusiveT::next(prev) = next;
+            } else {
+                p_firstchild = next;
+            }
+
+            if (next) {
+                intrusiveT::prev(next) = prev;
+            } else {
+                p_lastchild = prev;
+            }
+
+            intrusiveT::prev(first) = nullptr;
+            intrusiveT::next(last) = nullptr;
+        }
+
+        // links detached chain before where, doesn't change count
+        void Link(T *where, T *first, T *last)
+        {
+            auto prev = where ? intrusiveT::prev(where) : p_lastchild;
+
+            intrusiveT::prev(first) = prev;
+            intrusiveT::next(last) = where;
+
+            if (prev) {
+                intrusiveT::next(prev) = first;
+            } else {
+                p_firstchild = first;
+            }
+
+            if (where) {
+                intrusiveT::prev(where) = last;
+            } else {
+                p_lastchild = last;
+            }
+        }
+
     public:
         struct Links
         {
@@ -0,0 +1,490 @@
+/*
+        intrusive red-black tree
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+
+namespace c_common
+{
+    template <typename T>
+    class IntrusiveTreeDefaultAdapter
+    {
+    public:
+        static T * &parent(T *item) { return item->treeparent; }
+        static T * &left(T *item) { return item->treeleft; }
+        static T * &right(T *item) { return item->treeright; }
+        static bool &red(T *item) { return item->treered; }
+
+        static bool less(const T *a, const T *b) { return *a < *b; }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     IntrusiveTree<T, intrusiveT>
+     -------------------------------------------------------------------------------
+         ordered container of items which carry tree links (red-black tree)
+
+            struct Timer : IntrusiveTree<Timer>::Links
+            {
+                uint64_t deadline;
+                bool operator<(const Timer &other) const { return deadline < other.deadline; }
+            };
+
+            IntrusiveTree<Timer> timers;
+            timers.Insert(timer);
+            while (timers.front() && timers.front()->deadline <= now) {
+                auto expired = timers.PopFront();
+                ...
+            }
+
+         Insert() and Remove() are O(log n), front() is O(1), items are
+         ordered by intrusiveT::less(), items with equal keys are kept in
+         insertion order
+
+         like IntrusiveList, tree does not own items and doesn't allocate
+         memory, item must not be in other tree using the same links, key
+         must not change while item is in tree (remove, change, insert)
+    */
+
+    template <typename T, typename intrusiveT = IntrusiveTreeDefaultAdapter<T>>
+    class IntrusiveTree
+    {
+    public:
+        class ForwardIterator
+        {
+        public:
+            ForwardIterator() noexcept :
+                p_current(nullptr)
+            {}
+
+            ForwardIterator(T *item) noexcept :
+                p_current(item)
+            {}
+
+            T *operator*() const noexcept { return p_current; }
+            T *operator->() const noexcept { return p_current; }
+
+            bool operator==(const ForwardIterator &other) const noexcept { return p_current == other.p_current; }
+            bool operator!=(const ForwardIterator &other) const noexcept { return p_current != other.p_current; }
+
+            ForwardIterator &operator++()
+            {
+                p_current = IntrusiveTree<T, intrusiveT>::next(p_current);
+                return *this;
+            }
+
+        private:
+            T *p_current;
+        };
+
+    public:
+        IntrusiveTree() :
+            p_root(nullptr),
+            p_first(nullptr),
+            p_count(0)
+        {}
+
+        IntrusiveTree(const IntrusiveTree &) = delete;
+        IntrusiveTree &operator=(const IntrusiveTree &) = delete;
+
+        ForwardIterator begin() const noexcept { return ForwardIterator(p_first); }
+        ForwardIterator end() const noexcept { return ForwardIterator(); }
+
+        // first (smallest) item
+        T *front() const noexcept { return p_first; }
+
+        // last (largest) item
+        T *back() const noexcept
+        {
+            return p_root ? maximum(p_root) : nullptr;
+        }
+
+        size_t size() const noexcept { return p_count; }
+
+        // item following given one in order, nullptr for last item
+        static T *next(T *item)
+        {
+            if (auto right = intrusiveT::right(item)) {
+                return minimum(right);
+            }
+
+            auto parent = intrusiveT::parent(item);
+            while (parent && item == intrusiveT::right(parent)) {
+                item = parent;
+                parent = intrusiveT::parent(item);
+            }
+
+            return parent;
+        }
+
+        // item preceding given one in order, nullptr for first item
+        static T *prev(T *item)
+        {
+            if (auto left = intrusiveT::left(item)) {
+                return maximum(left);
+            }
+
+            auto parent = intrusiveT::parent(item);
+            while (parent && item == intrusiveT::left(parent)) {
+                item = parent;
+                parent = intrusiveT::parent(item);
+            }
+
+            return parent;
+        }
+
+        // first item for which less(item, value) is false, value is passed
+        // as second argument to less, so it could be key of other type
+        template <typename V, typename L>
+        T *LowerBound(const V &value, L less) const
+        {
+            T *result = nullptr;
+            for (auto item = p_root; item; ) {
+                if (less(item, value)) {
+                    item = intrusiveT::right(item);
+                } else {
+                    result = item;
+                    item = intrusiveT::left(item);
+                }
+            }
+            return result;
+        }
+
+        void Insert(T *item)
+        {
+            T *parent = nullptr;
+            auto isleft = false;
+
+            // equal items go right, after existing ones
+            for (auto current = p_root; current; ) {
+                parent = current;
+                isleft = intrusiveT::less(item, current);
+                current = isleft ? intrusiveT::left(current) : intrusiveT::right(current);
+            }
+
+            intrusiveT::parent(item) = parent;
+            intrusiveT::left(item) = nullptr;
+            intrusiveT::right(item) = nullptr;
+            intrusiveT::red(item) = true;
+
+            if (parent == nullptr) {
+                p_root = item;
+            } else if (isleft) {
+                intrusiveT::left(parent) = item;
+            } else {
+                intrusiveT::right(parent) = item;
+            }
+
+            if (p_first == nullptr || intrusiveT::less(item, p_first)) {
+                p_first = item;
+            }
+
+            InsertFixup(item);
+            ++p_count;
+        }
+
+        void Remove(T *item)
+        {
+            if (item == p_first) {
+                p_first = next(item);
+            }
+
+            auto removedred = intrusiveT::red(item);
+            T *child;       // item which took place of removed one
+            T *childparent; // its parent, child could be nullptr
+
+            auto left = intrusiveT::left(item);
+            auto right = intrusiveT::right(item);
+
+            if (left == nullptr || right == nullptr) {
+                child = left ? left : right;
+                childparent = intrusiveT::parent(item);
+                Transplant(item, child);
+            } else {
+                // successor takes place of the item
+                auto successor = minimum(right);
+                removedred = intrusiveT::red(successor);
+                child = intrusiveT::right(successor);
+
+                if (intrusiveT::parent(successor) == item) {
+                    childparent = successor;
+                } else {
+                    childparent = intrusiveT::parent(successor);
+                    Transplant(successor, child);
+                    intrusiveT::right(successor) = right;
+                    intrusiveT::parent(right) = successor;
+                }
+
+                Transplant(item, successor);
+                intrusiveT::left(successor) = left;
+                intrusiveT::parent(left) = successor;
+                intrusiveT::red(successor) = intrusiveT::red(item);
+            }
+
+            if (!removedred) {
+                RemoveFixup(child, childparent);
+            }
+
+            intrusiveT::parent(item) = nullptr;
+            intrusiveT::left(item) = nullptr;
+            intrusiveT::right(item) = nullptr;
+            intrusiveT::red(item) = false;
+
+            --p_count;
+        }
+
+        // removes and returns first item, nullptr if tree is empty
+        T *PopFront()
+        {
+            auto item = p_first;
+            if (item) {
+                Remove(item);
+            }
+            return item;
+        }
+
+        // detaches all items
+        void Clear()
+        {
+            // post order walk, links are cleared on the way
+            auto item = p_root;
+            while (item) {
+                if (auto left = intrusiveT::left(item)) {
+                    intrusiveT::left(item) = nullptr;
+                    item = left;
+                } else if (auto right = intrusiveT::right(item)) {
+                    intrusiveT::right(item) = nullptr;
+                    item = right;
+                } else {
+                    auto parent = intrusiveT::parent(item);
+                    intrusiveT::parent(item) = nullptr;
+                    intrusiveT::red(item) = false;
+                    item = parent;
+                }
+            }
+
+            p_root = nullptr;
+            p_first = nullptr;
+            p_count = 0;
+        }
+
+    public:
+        struct Links
+        {
+            Links() :
+                treeparent(nullptr),
+                treeleft(nullptr),
+                treeright(nullptr),
+                treered(false)
+            {}
+
+            T    *treeparent;
+            T    *treeleft;
+            T    *treeright;
+            bool  treered;
+        };
+
+    private:
+        static T *minimum(T *item)
+        {
+            while (auto left = intrusiveT::left(item)) {
+                item = left;
+            }
+            return item;
+        }
+
+        static T *maximum(T *item)
+        {
+            while (auto right = intrusiveT::right(item)) {
+                item = right;
+            }
+            return item;
+        }
+
+        static bool isred(T *item)
+        {
+            return item && intrusiveT::red(item);
+        }
+
+        // puts replacement at place of item in item's parent
+        void Transplant(T *item, T *replacement)
+        {
+            auto parent = intrusiveT::parent(item);
+
+            if (parent == nullptr) {
+                p_root = replacement;
+            } else if (item == intrusiveT::left(parent)) {
+                intrusiveT::left(parent) = replacement;
+            } else {
+                intrusiveT::right(parent) = replacement;
+            }
+
+            if (replacement) {
+                intrusiveT::parent(replacement) = parent;
+            }
+        }
+
+        void RotateLeft(T *item)
+        {
+            auto right = intrusiveT::right(item);
+
+            intrusiveT::right(item) = intrusiveT::left(right);
+            if (intrusiveT::left(right)) {
+                intrusiveT::parent(intrusiveT::left(right)) = item;
+            }
+
+            Transplant(item, right);
+
+            intrusiveT::left(right) = item;
+            intrusiveT::parent(item) = right;
+        }
+
+        void RotateRight(T *item)
+        {
+            auto left = intrusiveT::left(item);
+
+            intrusiveT::left(item) = intrusiveT::right(left);
+            if (intrusiveT::right(left)) {
+                intrusiveT::parent(intrusiveT::right(left)) = item;
+            }
+
+            Transplant(item, left);
+
+            intrusiveT::right(left) = item;
+            intrusiveT::parent(item) = left;
+        }
+
+        void InsertFixup(T *item)
+        {
+            T *parent;
+            while ((parent = intrusiveT::parent(item)) && intrusiveT::red(parent)) {
+                // red parent is never root, so grandparent exists
+                auto grandparent = intrusiveT::parent(parent);
+
+                if (parent == intrusiveT::left(grandparent)) {
+                    auto uncle = intrusiveT::right(grandparent);
+                    if (isred(uncle)) {
+                        intrusiveT::red(parent) = false;
+                        intrusiveT::red(uncle) = false;
+                        intrusiveT::red(grandparent) = true;
+                        item = grandparent;
+                        continue;
+                    }
+
+                    if (item == intrusiveT::right(parent)) {
+                        item = parent;
+                        RotateLeft(item);
+                        parent = intrusiveT::parent(item);
+                    }
+
+                    intrusiveT::red(parent) = false;
+                    intrusiveT::red(grandparent) = true;
+                    RotateRight(grandparent);
+                } else {
+                    auto uncle = intrusiveT::left(grandparent);
+                    if (isred(uncle)) {
+                        intrusiveT::red(parent) = false;
+                        intrusiveT::red(uncle) = false;
+                        intrusiveT::red(grandparent) = true;
+                        item = grandparent;
+                        continue;
+                    }
+
+                    if (item == intrusiveT::left(parent)) {
+                        item = parent;
+                        RotateRight(item);
+                        parent = intrusiveT::parent(item);
+                    }
+
+                    intrusiveT::red(parent) = false;
+                    intrusiveT::red(grandparent) = true;
+                    RotateLeft(grandparent);
+                }
+            }
+
+            intrusiveT::red(p_root) = false;
+        }
+
+        // restores black height after black item removal, item could be
+        // nullptr, so its parent is passed separately
+        void RemoveFixup(T *item, T *parent)
+        {
+            while (item != p_root && !isred(item)) {
+                if (item == intrusiveT::left(parent)) {
+                    auto sibling = intrusiveT::right(parent);
+                    if (isred(sibling)) {
+                        intrusiveT::red(sibling) = false;
+                        intrusiveT::red(parent) = true;
+                        RotateLeft(parent);
+                        sibling = intrusiveT::right(parent);
+                    }
+
+                    if (!isred(intrusiveT::left(sibling)) && !isred(intrusiveT::right(sibling))) {
+                        intrusiveT::red(sibling) = true;
+                        item = parent;
+                        parent = intrusiveT::parent(item);
+                        continue;
+                    }
+
+                    if (!isred(intrusiveT::right(sibling))) {
+                        intrusiveT::red(intrusiveT::left(sibling)) = false;
+                        intrusiveT::red(sibling) = true;
+                        RotateRight(sibling);
+                        sibling = intrusiveT::right(parent);
+                    }
+
+                    intrusiveT::red(sibling) = intrusiveT::red(parent);
+                    intrusiveT::red(parent) = false;
+                    intrusiveT::red(intrusiveT::right(sibling)) = false;
+                    RotateLeft(parent);
+                } else {
+                    auto sibling = intrusiveT::left(parent);
+                    if (isred(sibling)) {
+                        intrusiveT::red(sibling) = false;
+                        intrusiveT::red(parent) = true;
+                        RotateRight(parent);
+                        sibling = intrusiveT::left(parent);
+                    }
+
+                    if (!isred(intrusiveT::left(sibling)) && !isred(intrusiveT::right(sibling))) {
+                        intrusiveT::red(sibling) = true;
+                        item = parent;
+                        parent = intrusiveT::parent(item);
+                        continue;
+                    }
+
+                    if (!isred(intrusiveT::left(sibling))) {
+                        intrusiveT::red(intrusiveT::right(sibling)) = false;
+                        intrusiveT::red(sibling) = true;
+                        RotateLeft(sibling);
+                        sibling = intrusiveT::left(parent);
+                    }
+
+                    intrusiveT::red(sibling) = intrusiveT::red(parent);
+                    intrusiveT::red(parent) = false;
+                    intrusiveT::red(intrusiveT::left(sibling)) = false;
+                    RotateRight(parent);
+                }
+
+                item = p_root;
+            }
+
+            if (item) {
+                intrusiveT::red(item) = false;
+            }
+        }
+
+    private:
+        T      *p_root;
+        T      *p_first;
+        size_t  p_count;
+    };
+}
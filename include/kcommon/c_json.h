@@ -0,0 +1,1108 @@
+/*
+        JSON reading and writing
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_strutil.h"
+#include "c_stringbuilder.h"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KCOMMON_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace c_common
+{
+    // index of lowest set bit, bits should not be 0
+    inline size_t JsonTrailingZeroes(uint64_t bits) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+
+    /*
+     -------------------------------------------------------------------------------
+     JsonStructuralIndexer
+     -------------------------------------------------------------------------------
+         stage 1 of JSON parsing
+
+         text is classified in 64 byte blocks, each block produces bit mask of
+         "structural" positions:
+            - operators { } [ ] : , outside of strings
+            - opening quotes of strings
+            - first characters of other scalars (numbers, true, false, null)
+
+         everything inside strings (including escaped quotes) is masked out, so
+         stage 2 only visits positions which really matter
+
+         blocks are classified lazily while next() walks through positions,
+         so index never allocates and works with any text size
+    */
+
+    class JsonStructuralIndexer
+    {
+    public:
+        JsonStructuralIndexer(const char *text, size_t size) noexcept :
+            p_text(text),
+            p_size(size),
+            p_block(0),
+            p_nextblock(0),
+            p_structurals(0),
+            p_prevodd(0),
+            p_previnstring(0),
+            p_prevscalar(0)
+        {}
+
+        // returns position of next structural character or size of text
+        // if there's nothing more
+        size_t next() noexcept
+        {
+            while (p_structurals == 0) {
+                if (p_nextblock >= p_size) {
+                    return p_size;
+                }
+
+                p_block = p_nextblock;
+                p_nextblock += 64;
+                ScanBlock();
+            }
+
+            auto bit = JsonTrailingZeroes(p_structurals);
+            p_structurals &= p_structurals - 1;
+
+            return p_block + bit;
+        }
+
+    private:
+        void ScanBlock() noexcept
+        {
+            auto block = p_text + p_block;
+            auto remaining = p_size - p_block;
+
+            // last incomplete block is padded with spaces which are
+            // never structural
+            char padded[64];
+            if (remaining < 64) {
+                memset(padded, ' ', 64);
+                memcpy(padded, block, remaining);
+                block = padded;
+            }
+
+            uint64_t ops, ws, quote, backslash;
+            Classify(block, ops, ws, quote, backslash);
+
+            auto escaped = OddBackslashEnds(backslash);
+            quote &= ~escaped;
+
+            // inside string mask includes opening quote and excludes closing one
+            auto instring = PrefixXor(quote) ^ p_previnstring;
+            p_previnstring = uint64_t(int64_t(instring) >> 63);
+
+            // string contents with closing quote
+            auto stringtail = instring ^ quote;
+
+            // quote is scalar too, but scalar which follows closing quote
+            // must start new token, so only non quote scalars are followed
+            auto scalar = ~(ops | ws);
+            auto nonquote = scalar & ~quote;
+            auto scalarstart = scalar & ~((nonquote << 1) | p_prevscalar);
+            p_prevscalar = nonquote >> 63;
+
+            p_structurals = (ops | scalarstart | (quote & instring)) & ~stringtail;
+
+            if (remaining < 64) {
+                p_structurals &= (uint64_t(1) << remaining) - 1;
+            }
+        }
+
+        static void Classify(const char *block, uint64_t &ops, uint64_t &ws, uint64_t &quote, uint64_t &backslash) noexcept
+        {
+#if KCOMMON_JSON_SSE2
+            ops = ws = quote = backslash = 0;
+
+            auto lower = _mm_set1_epi8(0x20);
+            auto opencurly = _mm_set1_epi8('{');
+            auto closecurly = _mm_set1_epi8('}');
+            auto colon = _mm_set1_epi8(':');
+            auto comma = _mm_set1_epi8(',');
+            auto space = _mm_set1_epi8(' ');
+            auto tab = _mm_set1_epi8('\t');
+            auto lf = _mm_set1_epi8('\n');
+            auto cr = _mm_set1_epi8('\r');
+            auto dquote = _mm_set1_epi8('"');
+            auto bslash = _mm_set1_epi8('\\');
+
+            for (auto n = 0; n < 4; ++n) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + n * 16));
+
+                // '[' and ']' differ from '{' and '}' only by 0x20 bit
+                auto folded = _mm_or_si128(v, lower);
+                auto o = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(folded, opencurly), _mm_cmpeq_epi8(folded, closecurly)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma))
+                );
+                auto w = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))
+                );
+
+                auto shift = n * 16;
+                ops |= uint64_t(uint16_t(_mm_movemask_epi8(o))) << shift;
+                ws |= uint64_t(uint16_t(_mm_movemask_epi8(w))) << shift;
+                quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, dquote)))) << shift;
+                backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash)))) << shift;
+            }
+#else
+            ops = ws = quote = backslash = 0;
+
+            for (auto n = 0; n < 64; ++n) {
+                auto bit = uint64_t(1) << n;
+                switch (block[n]) {
+                    case '{': case '}': case '[': case ']': case ':': case ',':
+                        ops |= bit;
+                        break;
+
+                    case ' ': case '\t': case '\n': case '\r':
+                        ws |= bit;
+                        break;
+
+                    case '"':
+                        quote |= bit;
+                        break;
+
+                    case '\\':
+                        backslash |= bit;
+                        break;
+                }
+            }
+#endif
+        }
+
+        // returns mask of characters which follow odd length backslash sequences,
+        // i.e. escaped characters
+        uint64_t OddBackslashEnds(uint64_t backslash) noexcept
+        {
+            const auto evenbits = uint64_t(0x5555555555555555);
+            const auto oddbits = ~evenbits;
+
+            auto startedges = backslash & ~(backslash << 1);
+            // flip lowest if previous block ended with odd length sequence
+            auto evenstartmask = evenbits ^ p_prevodd;
+            auto evenstarts = startedges & evenstartmask;
+            auto oddstarts = startedges & ~evenstartmask;
+
+            auto evencarries = backslash + evenstarts;
+            auto oddcarries = backslash + oddstarts;
+            auto oddoverflow = oddcarries < backslash;
+
+            oddcarries |= p_prevodd;
+            p_prevodd = oddoverflow ? 1 : 0;
+
+            auto evencarryends = evencarries & ~backslash;
+            auto oddcarryends = oddcarries & ~backslash;
+
+            return (evencarryends & oddbits) | (oddcarryends & evenbits);
+        }
+
+        static uint64_t PrefixXor(uint64_t bits) noexcept
+        {
+            bits ^= bits << 1;
+            bits ^= bits << 2;
+            bits ^= bits << 4;
+            bits ^= bits << 8;
+            bits ^= bits << 16;
+            bits ^= bits << 32;
+            return bits;
+        }
+
+    private:
+        const char *p_text;
+        size_t      p_size;
+        size_t      p_block;        // start of currently indexed block
+        size_t      p_nextblock;    // start of next block to index
+        uint64_t    p_structurals;  // not yet visited structurals of current block
+        uint64_t    p_prevodd;      // previous block ended with odd backslash sequence
+        uint64_t    p_previnstring; // previous block ended inside string (all ones)
+        uint64_t    p_prevscalar;   // previous block ended with non quote scalar character
+    };
+
+
+    // JSON token type (returned from JsonReader::next())
+    enum class JsonToken
+    {
+        None,        // nothing has been read yet
+        ObjectStart,
+        ObjectEnd,
+        ArrayStart,
+        ArrayEnd,
+        Key,         // object member name, text() is raw name without quotes
+        String,      // text() is raw string contents without quotes
+        Number,      // text() is number text, parsed only on request
+        True,
+        False,
+        Null,
+        End,         // whole document has been read
+        Error        // malformed document, offset() points to error location
+    };
+
+    /*
+     -------------------------------------------------------------------------------
+     JsonReader
+     -------------------------------------------------------------------------------
+         pull JSON parser
+
+         reader walks positions found by JsonStructuralIndexer and reports
+         tokens one by one on every next() call
+
+         all token text is returned as StringView into source text, so
+         reader doesn't allocate anything. strings with escape sequences
+         are also reported raw, escaped() tells if string has to be decoded
+         with unescape(), strings with raw control characters or unknown
+         escapes are rejected while reading
+
+         numbers are not converted while reading, use asint(), asint64(),
+         asuint64() or asdouble() to get the value of Number token
+
+         source text should outlive reader and all views returned by it
+    */
+
+    class JsonReader
+    {
+    public:
+        enum
+        {
+            MAX_DEPTH = 256
+        };
+
+    public:
+        JsonReader(const StringView &text) noexcept :
+            p_text(text),
+            p_indexer(text.data(), text.size()),
+            p_token(JsonToken::None),
+            p_expect(Expect::Value),
+            p_value(),
+            p_offset(0),
+            p_depth(0),
+            p_escaped(false)
+        {}
+
+        // reads next token, after End or Error the same token is returned
+        JsonToken next() noexcept
+        {
+            if (p_token == JsonToken::End || p_token == JsonToken::Error) {
+                return p_token;
+            }
+
+            for (;;) {
+                auto pos = p_indexer.next();
+
+                if (pos >= p_text.size()) {
+                    if (p_expect == Expect::Done) {
+                        p_offset = pos;
+                        p_value = {};
+                        return p_token = JsonToken::End;
+                    }
+                    return Fail(pos);
+                }
+
+                auto c = p_text.data()[pos];
+
+                switch (p_expect) {
+                    case Expect::Colon:
+                        if (c != ':') {
+                            return Fail(pos);
+                        }
+                        p_expect = Expect::Value;
+                        break;
+
+                    case Expect::CommaOrEnd:
+                        if (c == ',') {
+                            p_expect = inobject() ? Expect::Key : Expect::Value;
+                            break;
+                        }
+                        if (c != '}' && c != ']') {
+                            return Fail(pos);
+                        }
+                        return CloseContainer(pos, c);
+
+                    case Expect::KeyOrEnd:
+                        if (c == '}') {
+                            return CloseContainer(pos, c);
+                        }
+                        [[fallthrough]];
+
+                    case Expect::Key:
+                        if (c != '"') {
+                            return Fail(pos);
+                        }
+                        p_expect = Expect::Colon;
+                        return ReadString(pos, JsonToken::Key);
+
+                    case Expect::ValueOrEnd:
+                        if (c == ']') {
+                            return CloseContainer(pos, c);
+                        }
+                        [[fallthrough]];
+
+                    case Expect::Value:
+                        return ReadValue(pos, c);
+
+                    case Expect::Done:
+                        // garbage after root value
+                        return Fail(pos);
+                }
+            }
+        }
+
+        // skips current value, if current token is ObjectStart or ArrayStart
+        // whole object or array is skipped including its end token
+        bool skip() noexcept
+        {
+            if (p_token != JsonToken::ObjectStart && p_token != JsonToken::ArrayStart) {
+                return p_token != JsonToken::Error;
+            }
+
+            auto depth = p_depth;
+            while (p_depth >= depth) {
+                auto token = next();
+                if (token == JsonToken::Error || token == JsonToken::End) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        JsonToken token() const noexcept { return p_token; }
+        StringView text() const noexcept { return p_value; }
+        size_t offset() const noexcept { return p_offset; }
+        size_t depth() const noexcept { return p_depth; }
+
+        // true if current Key or String token contains escape sequences
+        bool escaped() const noexcept { return p_escaped; }
+
+        bool asint(int &result, int defaultval = 0) const noexcept
+        {
+            if (p_token != JsonToken::Number) {
+                result = defaultval;
+                return false;
+            }
+            return ParseInt(p_value, result, defaultval);
+        }
+
+        // whole 64 bit numbers like ids and timestamps, fails when number
+        // has fraction or exponent or doesn't fit the type
+        bool asint64(int64_t &result, int64_t defaultval = 0) const noexcept
+        {
+            return ParseNumber(result, defaultval);
+        }
+
+        bool asuint64(uint64_t &result, uint64_t defaultval = 0) const noexcept
+        {
+            return ParseNumber(result, defaultval);
+        }
+
+        // nearest double to number text, fails when it's out of range
+        bool asdouble(double &result, double defaultval = 0) const noexcept
+        {
+            return ParseNumber(result, defaultval);
+        }
+
+        // decodes current Key or String token
+        //      buffer - storage for decoded text, should be at least text().size()
+        //               long, it's not used when string has no escapes
+        //      result - decoded text (UTF-8), either view into source text or
+        //               into the buffer
+        bool unescape(const MutableSpan<char> &buffer, StringView &result) const noexcept
+        {
+            if (!p_escaped) {
+                result = p_value;
+                return p_token == JsonToken::Key || p_token == JsonToken::String;
+            }
+
+            if (buffer.size() < p_value.size()) {
+                result = {};
+                return false;
+            }
+
+            auto s = p_value.begin();
+            auto e = p_value.end();
+            auto d = buffer.data();
+
+            while (s != e) {
+                if (*s != '\\') {
+                    *d++ = *s++;
+                    continue;
+                }
+
+                if (++s == e) {
+                    result = {};
+                    return false;
+                }
+
+                switch (*s++) {
+                    case '"':  *d++ = '"'; break;
+                    case '\\': *d++ = '\\'; break;
+                    case '/':  *d++ = '/'; break;
+                    case 'b':  *d++ = '\b'; break;
+                    case 'f':  *d++ = '\f'; break;
+                    case 'n':  *d++ = '\n'; break;
+                    case 'r':  *d++ = '\r'; break;
+                    case 't':  *d++ = '\t'; break;
+
+                    case 'u': {
+                        auto code = 0u;
+                        if (!ReadHex4(s, e, code)) {
+                            result = {};
+                            return false;
+                        }
+
+                        // surrogate pair
+                        if (code >= 0xD800 && code < 0xDC00) {
+                            auto low = 0u;
+                            if ((e - s) < 6 || s[0] != '\\' || s[1] != 'u') {
+                                result = {};
+                                return false;
+                            }
+                            s += 2;
+                            if (!ReadHex4(s, e, low) || low < 0xDC00 || low > 0xDFFF) {
+                                result = {};
+                                return false;
+                            }
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+
+                        d = EncodeUTF8(d, code);
+                        break;
+                    }
+
+                    default:
+                        result = {};
+                        return false;
+                }
+            }
+
+            result = StringView(buffer.data(), d - buffer.data());
+            return true;
+        }
+
+    private:
+        enum class Expect
+        {
+            Value,
+            ValueOrEnd,
+            Key,
+            KeyOrEnd,
+            Colon,
+            CommaOrEnd,
+            Done
+        };
+
+        template <typename V>
+        bool ParseNumber(V &result, V defaultval) const noexcept
+        {
+            if (p_token == JsonToken::Number) {
+                auto end = p_value.data() + p_value.size();
+                auto parsed = std::from_chars(p_value.data(), end, result);
+                if (parsed.ec == std::errc() && parsed.ptr == end) {
+                    return true;
+                }
+            }
+
+            result = defaultval;
+            return false;
+        }
+
+        bool inobject() const noexcept
+        {
+            return p_depth > 0 && p_containers[p_depth - 1] == '{';
+        }
+
+        void ValueRead() noexcept
+        {
+            p_expect = p_depth == 0 ? Expect::Done : Expect::CommaOrEnd;
+        }
+
+        JsonToken Fail(size_t pos) noexcept
+        {
+            p_offset = pos;
+            p_value = {};
+            return p_token = JsonToken::Error;
+        }
+
+        JsonToken SetToken(JsonToken token, size_t pos, size_t length) noexcept
+        {
+            p_offset = pos;
+            p_value = p_text.substr(pos, length);
+            return p_token = token;
+        }
+
+        JsonToken OpenContainer(size_t pos, char c, JsonToken token) noexcept
+        {
+            if (p_depth == MAX_DEPTH) {
+                return Fail(pos);
+            }
+
+            p_containers[p_depth++] = c;
+            p_expect = c == '{' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+            p_escaped = false;
+
+            return SetToken(token, pos, 1);
+        }
+
+        JsonToken CloseContainer(size_t pos, char c) noexcept
+        {
+            if (p_depth == 0 || (c == '}' && p_containers[p_depth - 1] != '{') || (c == ']' && p_containers[p_depth - 1] != '[')) {
+                return Fail(pos);
+            }
+
+            --p_depth;
+            ValueRead();
+            p_escaped = false;
+
+            return SetToken(c == '}' ? JsonToken::ObjectEnd : JsonToken::ArrayEnd, pos, 1);
+        }
+
+        JsonToken ReadValue(size_t pos, char c) noexcept
+        {
+            switch (c) {
+                case '{': return OpenContainer(pos, c, JsonToken::ObjectStart);
+                case '[': return OpenContainer(pos, c, JsonToken::ArrayStart);
+                case '"': return ReadString(pos, JsonToken::String);
+            }
+
+            p_escaped = false;
+
+            auto length = ScalarLength(pos);
+            auto scalar = p_text.substr(pos, length);
+            auto token = JsonToken::Error;
+
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                if (ValidNumber(scalar)) {
+                    token = JsonToken::Number;
+                }
+            } else if (scalar == "true") {
+                token = JsonToken::True;
+            } else if (scalar == "false") {
+                token = JsonToken::False;
+            } else if (scalar == "null") {
+                token = JsonToken::Null;
+            }
+
+            if (token == JsonToken::Error) {
+                return Fail(pos);
+            }
+
+            ValueRead();
+            return SetToken(token, pos, length);
+        }
+
+        JsonToken ReadString(size_t pos, JsonToken token) noexcept
+        {
+            auto text = p_text.data();
+            auto size = p_text.size();
+            auto start = pos + 1;
+            auto from = start;
+
+            // indexer guarantees there's no structurals inside the string,
+            // so closing quote just has to be found
+            for (;;) {
+                auto quote = static_cast<const char*>(memchr(text + from, '"', size - from));
+                if (quote == nullptr) {
+                    return Fail(pos);
+                }
+
+                auto end = size_t(quote - text);
+
+                auto backslashes = size_t(0);
+                while ((end - backslashes) > start && text[end - backslashes - 1] == '\\') {
+                    ++backslashes;
+                }
+
+                if ((backslashes & 1) == 0) {
+                    auto escaped = false;
+                    if (!ValidString(text + start, text + end, escaped)) {
+                        return Fail(pos);
+                    }
+
+                    if (token == JsonToken::String) {
+                        ValueRead();
+                    }
+
+                    p_escaped = escaped;
+                    p_offset = pos;
+                    p_value = p_text.substr(start, end - start);
+                    return p_token = token;
+                }
+
+                from = end + 1;
+            }
+        }
+
+        // checks string contents for raw control characters and unknown
+        // escape sequences, tells if there are any escapes
+        static bool ValidString(const char *s, const char *e, bool &escaped) noexcept
+        {
+            while (s != e) {
+                auto c = static_cast<unsigned char>(*s++);
+
+                if (c < 0x20) {
+                    return false;
+                }
+
+                if (c != '\\') {
+                    continue;
+                }
+
+                escaped = true;
+                if (s == e) {
+                    return false;
+                }
+
+                switch (*s++) {
+                    case '"': case '\\': case '/': case 'b':
+                    case 'f': case 'n': case 'r': case 't':
+                        break;
+
+                    case 'u': {
+                        auto code = 0u;
+                        if (!ReadHex4(s, e, code)) {
+                            return false;
+                        }
+                        break;
+                    }
+
+                    default:
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        size_t ScalarLength(size_t pos) const noexcept
+        {
+            auto p = p_text.data() + pos;
+            auto e = p_text.end();
+            auto s = p;
+
+            while (p != e) {
+                switch (*p) {
+                    case '{': case '}': case '[': case ']': case ':': case ',':
+                    case ' ': case '\t': case '\n': case '\r': case '"':
+                        return p - s;
+                }
+                ++p;
+            }
+
+            return p - s;
+        }
+
+        // checks number against -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        static bool ValidNumber(const StringView &number) noexcept
+        {
+            auto s = number.begin();
+            auto e = number.end();
+
+            auto digits = [&s, e]() noexcept {
+                auto start = s;
+                while (s != e && *s >= '0' && *s <= '9') {
+                    ++s;
+                }
+                return s != start;
+            };
+
+            if (s != e && *s == '-') {
+                ++s;
+            }
+
+            if (s != e && *s == '0') {
+                ++s;
+            } else if (!digits()) {
+                return false;
+            }
+
+            if (s != e && *s == '.') {
+                ++s;
+                if (!digits()) {
+                    return false;
+                }
+            }
+
+            if (s != e && (*s == 'e' || *s == 'E')) {
+                ++s;
+                if (s != e && (*s == '+' || *s == '-')) {
+                    ++s;
+                }
+                if (!digits()) {
+                    return false;
+                }
+            }
+
+            return s == e;
+        }
+
+        static bool ReadHex4(const char *&s, const char *e, unsigned &code) noexcept
+        {
+            if ((e - s) < 4) {
+                return false;
+            }
+
+            code = 0;
+            for (auto n = 0; n < 4; ++n, ++s) {
+                auto c = *s;
+                code <<= 4;
+                if (c >= '0' && c <= '9') {
+                    code |= c - '0';
+                } else if (c >= 'a' && c <= 'f') {
+                    code |= c - 'a' + 10;
+                } else if (c >= 'A' && c <= 'F') {
+                    code |= c - 'A' + 10;
+                } else {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        static char *EncodeUTF8(char *d, unsigned code) noexcept
+        {
+            if (code < 0x80) {
+                *d++ = char(code);
+            } else if (code < 0x800) {
+                *d++ = char(0xC0 | (code >> 6));
+                *d++ = char(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                *d++ = char(0xE0 | (code >> 12));
+                *d++ = char(0x80 | ((code >> 6) & 0x3F));
+                *d++ = char(0x80 | (code & 0x3F));
+            } else {
+                *d++ = char(0xF0 | (code >> 18));
+                *d++ = char(0x80 | ((code >> 12) & 0x3F));
+                *d++ = char(0x80 | ((code >> 6) & 0x3F));
+                *d++ = char(0x80 | (code & 0x3F));
+            }
+            return d;
+        }
+
+    private:
+        StringView            p_text;
+        JsonStructuralIndexer p_indexer;
+        JsonToken             p_token;
+        Expect                p_expect;
+        StringView            p_value;
+        size_t                p_offset;
+        size_t                p_depth;
+        bool                  p_escaped;
+        char                  p_containers[MAX_DEPTH];
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     JsonWriter<N, R>
+     -------------------------------------------------------------------------------
+         JSON writer on top of StringBuilderBase
+
+         writer emits compact JSON into referenced builder, it takes care of
+         separators and string escaping only, document structure is not
+         validated (unbalanced calls are caught by asserts in debug)
+
+         containers nested deeper than MAX_DEPTH are not opened, writer
+         latches failed() state, output is incomplete then
+
+         strings are scanned for characters which need escaping 16 bytes at
+         a time, runs of safe characters are written with single Write() call
+
+         integers are written with builder formatters, doubles are written
+         with std::to_chars() as shortest text which reads back as the same
+         value, exponent is used where it's shorter
+    */
+
+    template <typename N = StringExcludeNull, typename R = StringBuilderStaticReallocator<char>>
+    class JsonWriter
+    {
+    public:
+        enum
+        {
+            MAX_DEPTH = 256,
+            MAX_PRECISION = 64  // limit of fractional digits for fixed precision values
+        };
+
+    public:
+        JsonWriter(StringBuilderBase<char, N, R> &builder) noexcept :
+            p_builder(builder),
+            p_depth(0),
+            p_skipped(0),
+            p_afterkey(false),
+            p_failed(false),
+            p_hasitems{}
+        {}
+
+        StringBuilderBase<char, N, R> &builder() const noexcept { return p_builder; }
+        size_t depth() const noexcept { return p_depth; }
+        bool failed() const noexcept { return p_failed; }
+
+        void BeginObject() { Open('{'); }
+        void EndObject() { Close('}'); }
+        void BeginArray() { Open('['); }
+        void EndArray() { Close(']'); }
+
+        template <typename M>
+        void Key(const StringViewBase<char, M> &name)
+        {
+            assert(!p_afterkey);
+            Separate();
+            WriteString(name);
+            p_builder.Write(":", 1);
+            p_afterkey = true;
+        }
+
+        template <size_t length>
+        void Key(const char(&name)[length])
+        {
+            Key(StringView(name));
+        }
+
+        template <typename M>
+        void Value(const StringViewBase<char, M> &value)
+        {
+            Separate();
+            WriteString(value);
+        }
+
+        template <size_t length>
+        void Value(const char(&value)[length])
+        {
+            Value(StringView(value));
+        }
+
+        void Value(int value) { Value((long long int)value); }
+        void Value(long int value) { Value((long long int)value); }
+        void Value(unsigned value) { Value((long long unsigned)value); }
+        void Value(long unsigned value) { Value((long long unsigned)value); }
+
+        void Value(long long int value)
+        {
+            Separate();
+            p_builder.Write(value);
+        }
+
+        void Value(long long unsigned value)
+        {
+            Separate();
+            p_builder.Write(value);
+        }
+
+        void Value(float value) { Value(double(value)); }
+
+        void Value(double value)
+        {
+            Separate();
+            WriteDouble(value, unsigned(-1));
+        }
+
+        // floating point value with given number of fractional digits (up to
+        // MAX_PRECISION)
+        void Value(double value, unsigned precision)
+        {
+            Separate();
+            WriteDouble(value, precision);
+        }
+
+        void Bool(bool value)
+        {
+            Separate();
+            if (value) {
+                p_builder.Write("true", 4);
+            } else {
+                p_builder.Write("false", 5);
+            }
+        }
+
+        void Null()
+        {
+            Separate();
+            p_builder.Write("null", 4);
+        }
+
+        // returns length of the longest prefix which can be written
+        // without escaping
+        static size_t SafeLength(const char *text, size_t size) noexcept
+        {
+            auto n = size_t(0);
+
+#if KCOMMON_JSON_SSE2
+            auto dquote = _mm_set1_epi8('"');
+            auto bslash = _mm_set1_epi8('\\');
+            auto control = _mm_set1_epi8(0x1F);
+
+            for (; (n + 16) <= size; n += 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + n));
+
+                // unsigned v <= 0x1F is max(v, 0x1F) == 0x1F
+                auto escape = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, dquote), _mm_cmpeq_epi8(v, bslash)),
+                    _mm_cmpeq_epi8(_mm_max_epu8(v, control), control)
+                );
+
+                auto mask = unsigned(_mm_movemask_epi8(escape));
+                if (mask) {
+                    return n + JsonTrailingZeroes(mask);
+                }
+            }
+#endif
+
+            for (; n < size; ++n) {
+                auto c = static_cast<unsigned char>(text[n]);
+                if (c < 0x20 || c == '"' || c == '\\') {
+                    break;
+                }
+            }
+
+            return n;
+        }
+
+    private:
+        void Separate()
+        {
+            if (p_afterkey) {
+                p_afterkey = false;
+                return;
+            }
+
+            if (p_depth > 0) {
+                if (p_hasitems[p_depth - 1]) {
+                    p_builder.Write(",", 1);
+                }
+                p_hasitems[p_depth - 1] = true;
+            }
+        }
+
+        void Open(char bracket)
+        {
+            // too deep container is refused, its closing call is skipped too
+            if (p_depth == MAX_DEPTH) {
+                p_failed = true;
+                ++p_skipped;
+                return;
+            }
+
+            Separate();
+            p_builder.Write(&bracket, 1);
+            p_hasitems[p_depth++] = false;
+        }
+
+        void Close(char bracket)
+        {
+            assert(p_depth > 0 && !p_afterkey);
+
+            if (p_skipped) {
+                --p_skipped;
+                return;
+            }
+
+            if (p_depth == 0) {
+                p_failed = true;
+                return;
+            }
+
+            --p_depth;
+            p_builder.Write(&bracket, 1);
+        }
+
+        template <typename M>
+        void WriteString(const StringViewBase<char, M> &text)
+        {
+            static const char hex[] = "0123456789abcdef";
+
+            p_builder.Write("\"", 1);
+
+            auto p = text.data();
+            auto e = p + text.size();
+
+            while (p != e) {
+                auto safe = SafeLength(p, e - p);
+                if (safe) {
+                    p_builder.Write(p, safe);
+                    p += safe;
+                    if (p == e) {
+                        break;
+                    }
+                }
+
+                auto c = static_cast<unsigned char>(*p++);
+                switch (c) {
+                    case '"':  p_builder.Write("\\\"", 2); break;
+                    case '\\': p_builder.Write("\\\\", 2); break;
+                    case '\b': p_builder.Write("\\b", 2); break;
+                    case '\f': p_builder.Write("\\f", 2); break;
+                    case '\n': p_builder.Write("\\n", 2); break;
+                    case '\r': p_builder.Write("\\r", 2); break;
+                    case '\t': p_builder.Write("\\t", 2); break;
+
+                    default: {
+                        char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                        p_builder.Write(escape, 6);
+                        break;
+                    }
+                }
+            }
+
+            p_builder.Write("\"", 1);
+        }
+
+        void WriteDouble(double value, unsigned precision)
+        {
+            // JSON has no representation for NaN and infinities
+            if (value != value || (value - value) != 0) {
+                p_builder.Write("null", 4);
+                return;
+            }
+
+            char buffer[DOUBLE_BUFFER_SIZE];
+            auto end = buffer + DOUBLE_BUFFER_SIZE;
+            auto result = precision == unsigned(-1) ?
+                std::to_chars(buffer, end, value) :
+                std::to_chars(buffer, end, value, std::chars_format::fixed, int(c_util::umin(precision, unsigned(MAX_PRECISION))));
+
+            p_builder.Write(buffer, size_t(result.ptr - buffer));
+        }
+
+    private:
+        enum
+        {
+            // fixed notation of largest double with MAX_PRECISION digits fits
+            DOUBLE_BUFFER_SIZE = 384
+        };
+
+        StringBuilderBase<char, N, R> &p_builder;
+        size_t                         p_depth;
+        size_t                         p_skipped;  // refused containers which aren't closed yet
+        bool                           p_afterkey;
+        bool                           p_failed;
+        bool                           p_hasitems[MAX_DEPTH];
+    };
+}
@@ -0,0 +1,154 @@
+/*
+        line by line text reader over streams
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include "c_stringview.h"
+#include <cstring>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     LineReader
+     -------------------------------------------------------------------------------
+         splits text from any streamT<size_t> into lines
+
+         source is read into large buffer, lines are found with memchr()
+         (which is vectorized by C library) and returned as StringView
+         pointing into the buffer, so returned line is valid only until
+         next call to next()
+
+         line ends with LF or CRLF, line terminator isn't included into
+         returned line, last line may have no terminator
+
+         when buffer runs out, unfinished line is moved to buffer start and
+         the rest of buffer is filled from source, this is the only case
+         when text gets copied, if single line doesn't fit buffer, buffer
+         grows twice
+    */
+
+    class LineReader
+    {
+    public:
+        LineReader(streamT<size_t> &source, size_t buffersize = 1024 * 1024) :
+            p_source(source),
+            p_buffer(nullptr),
+            p_capacity(c_util::umax(buffersize, size_t(256))),
+            p_current(0),
+            p_end(0),
+            p_scanned(0),
+            p_line(0),
+            p_eof(false)
+        {
+            p_buffer = new char[p_capacity];
+        }
+
+        LineReader(const LineReader &) = delete;
+        LineReader &operator=(const LineReader &) = delete;
+
+        ~LineReader()
+        {
+            delete[] p_buffer;
+        }
+
+        streamT<size_t> &source() const { return p_source; }
+
+        // number of lines returned so far
+        size_t line() const { return p_line; }
+
+        // reads next line, returns false when there are no more lines
+        bool next(StringView &line)
+        {
+            for (;;) {
+                auto start = p_buffer + p_current;
+                auto end = p_buffer + p_end;
+
+                // part before p_scanned is already known to have no newline
+                auto found = static_cast<char*>(memchr(p_buffer + p_scanned, '\n', end - (p_buffer + p_scanned)));
+                if (found) {
+                    p_current = size_t(found + 1 - p_buffer);
+                    p_scanned = p_current;
+                    return Result(start, found, line);
+                }
+
+                p_scanned = p_end;
+
+                if (p_eof || !Fill()) {
+                    if (start == end) {
+                        return false;
+                    }
+
+                    // last line without terminator
+                    p_current = p_end;
+                    p_scanned = p_end;
+                    return Result(start, end, line);
+                }
+            }
+        }
+
+    private:
+        bool Result(const char *start, const char *end, StringView &line)
+        {
+            if (end > start && end[-1] == '\r') {
+                --end;
+            }
+
+            line = StringView(start, size_t(end - start));
+            ++p_line;
+
+            return true;
+        }
+
+        // moves unfinished line to buffer start and reads more data
+        bool Fill()
+        {
+            auto tail = p_end - p_current;
+
+            if (tail == p_capacity) {
+                // line is longer than buffer
+                auto capacity = p_capacity * 2;
+                auto buffer = new char[capacity];
+                memcpy(buffer, p_buffer, tail);
+                delete[] p_buffer;
+                p_buffer = buffer;
+                p_capacity = capacity;
+            } else if (p_current > 0) {
+                memmove(p_buffer, p_buffer + p_current, tail);
+            }
+
+            p_scanned -= p_current;
+            p_current = 0;
+            p_end = tail;
+
+            auto amount = p_source.read(p_buffer + p_end, p_capacity - p_end);
+            p_end += amount;
+
+            if (amount == 0) {
+                p_eof = true;
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        streamT<size_t> &p_source;
+        char            *p_buffer;
+        size_t           p_capacity;
+        size_t           p_current;  // start of next line
+        size_t           p_end;      // end of valid data
+        size_t           p_scanned;  // end of data searched for newline
+        size_t           p_line;
+        bool             p_eof;
+    };
+}
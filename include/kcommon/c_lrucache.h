@@ -0,0 +1,455 @@
+/*
+        intrusive LRU cache
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_util.h"
+#include "c_stringview.h"
+#include "c_intrusivelist.h"
+#include <functional>
+#include <mutex>
+
+
+namespace c_common
+{
+    template <typename T, typename K>
+    class LRUCacheDefaultAdapter
+    {
+    public:
+        static const K &key(const T *item) { return item->cachekey; }
+        static size_t hash(const K &key) { return std::hash<K>()(key); }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     LRUCache<T, K, keyT, intrusiveT>
+     -------------------------------------------------------------------------------
+         bounded cache of items which carry IntrusiveList links and key
+
+            struct Entry : IntrusiveList<Entry>::Links
+            {
+                StringView cachekey;
+                ...
+            };
+
+            LRUCache<Entry> cache(1000);
+            if (auto entry = cache.Find(key)) { ... }
+
+         items are indexed by open addressing hash table of item pointers,
+         table is allocated once for given capacity, items are ordered by
+         IntrusiveList from least recently used (front) to most recently
+         used (back), Find() hit moves item to the back, so lookups,
+         inserts and touches don't allocate memory
+
+         like IntrusiveList, cache doesn't own items, Insert() returns item
+         which was evicted to make room (or replaced by new item with the
+         same key), Remove() and Evict() return detached items as well,
+         caller decides what to do with them
+
+         key returned by keyT must stay unchanged while item is in cache
+
+         cache isn't thread safe, see ShardedLRUCache
+    */
+
+    template <
+        typename T,
+        typename K = StringView,
+        typename keyT = LRUCacheDefaultAdapter<T, K>,
+        typename intrusiveT = IntrusiveListDefaultAdapter<T>
+    >
+    class LRUCache
+    {
+    public:
+        using List = IntrusiveList<T, intrusiveT>;
+
+    public:
+        LRUCache(size_t capacity = 0) :
+            p_slots(nullptr),
+            p_mask(0),
+            p_capacity(0),
+            p_hits(0),
+            p_misses(0),
+            p_evictions(0)
+        {
+            SetCapacity(capacity);
+        }
+
+        LRUCache(const LRUCache &) = delete;
+        LRUCache &operator=(const LRUCache &) = delete;
+
+        ~LRUCache()
+        {
+            Clear();
+            delete[] p_slots;
+        }
+
+        // sets max number of items, works only for empty cache
+        bool SetCapacity(size_t capacity)
+        {
+            if (p_items.size()) {
+                return false;
+            }
+
+            delete[] p_slots;
+            p_slots = nullptr;
+            p_mask = 0;
+            p_capacity = capacity;
+
+            if (capacity) {
+                // keep load factor at or below 1/2
+                auto slots = size_t(4);
+                while (slots < capacity * 2) {
+                    slots *= 2;
+                }
+
+                p_slots = new Slot[slots];
+                p_mask = slots - 1;
+            }
+
+            return true;
+        }
+
+        size_t capacity() const { return p_capacity; }
+        size_t size() const { return p_items.size(); }
+
+        size_t hits() const { return p_hits; }
+        size_t misses() const { return p_misses; }
+        size_t evictions() const { return p_evictions; }
+
+        void ResetCounters()
+        {
+            p_hits = 0;
+            p_misses = 0;
+            p_evictions = 0;
+        }
+
+        // least and most recently used items
+        T *front() const { return p_items.front(); }
+        T *back() const { return p_items.back(); }
+
+        // iterates from least to most recently used item
+        typename List::ForwardIterator begin() const { return p_items.begin(); }
+        typename List::ForwardIterator end() const { return p_items.end(); }
+
+        // finds item and marks it as most recently used
+        T *Find(const K &key)
+        {
+            auto index = Lookup(key, hashof(key));
+            if (index == NOT_FOUND) {
+                ++p_misses;
+                return nullptr;
+            }
+
+            ++p_hits;
+
+            auto item = p_slots[index].item;
+            Touch(item);
+
+            return item;
+        }
+
+        // finds item without changing its order and counters
+        T *Peek(const K &key) const
+        {
+            auto index = Lookup(key, hashof(key));
+            return index == NOT_FOUND ? nullptr : p_slots[index].item;
+        }
+
+        // marks item which is in cache as most recently used
+        void Touch(T *item)
+        {
+            if (item != p_items.back()) {
+                p_items.Remove(item);
+                p_items.Add(item);
+            }
+        }
+
+        // adds item as most recently used, returns replaced or evicted item
+        T *Insert(T *item)
+        {
+            // cache without capacity rejects item
+            if (p_capacity == 0) {
+                return item;
+            }
+
+            auto &key = keyT::key(item);
+            auto hash = hashof(key);
+
+            T *result = nullptr;
+
+            auto index = Lookup(key, hash);
+            if (index != NOT_FOUND) {
+                result = p_slots[index].item;
+                Erase(index);
+                p_items.Remove(result);
+            } else if (p_items.size() == p_capacity) {
+                result = Evict();
+                ++p_evictions;
+            }
+
+            index = hash & p_mask;
+            while (p_slots[index].item) {
+                index = (index + 1) & p_mask;
+            }
+
+            p_slots[index].item = item;
+            p_slots[index].hash = hash;
+            p_items.Add(item);
+
+            return result;
+        }
+
+        // removes item by key, returns removed item or nullptr
+        T *Remove(const K &key)
+        {
+            auto index = Lookup(key, hashof(key));
+            if (index == NOT_FOUND) {
+                return nullptr;
+            }
+
+            auto item = p_slots[index].item;
+            Erase(index);
+            p_items.Remove(item);
+
+            return item;
+        }
+
+        // removes least recently used item, returns nullptr if cache is empty
+        T *Evict()
+        {
+            auto item = p_items.front();
+            if (item) {
+                Remove(keyT::key(item));
+            }
+            return item;
+        }
+
+        // detaches all items
+        void Clear()
+        {
+            while (p_items.size()) {
+                p_items.Remove(p_items.front());
+            }
+
+            if (p_slots) {
+                for (auto n = size_t(0); n <= p_mask; ++n) {
+                    p_slots[n].item = nullptr;
+                }
+            }
+        }
+
+        // mixed key hash, low bits select slot
+        static size_t hashof(const K &key)
+        {
+            return c_util::hashmix(keyT::hash(key));
+        }
+
+    private:
+        enum : size_t
+        {
+            NOT_FOUND = size_t(-1)
+        };
+
+        struct Slot
+        {
+            T      *item = nullptr;
+            size_t  hash = 0;
+        };
+
+        size_t Lookup(const K &key, size_t hash) const
+        {
+            if (p_slots == nullptr) {
+                return NOT_FOUND;
+            }
+
+            for (auto index = hash & p_mask; p_slots[index].item; index = (index + 1) & p_mask) {
+                if (p_slots[index].hash == hash && keyT::key(p_slots[index].item) == key) {
+                    return index;
+                }
+            }
+
+            return NOT_FOUND;
+        }
+
+        // frees slot shifting following items of the same probe run back,
+        // so table never has tombstones
+        void Erase(size_t index)
+        {
+            auto next = index;
+            for (;;) {
+                next = (next + 1) & p_mask;
+                if (p_slots[next].item == nullptr) {
+                    break;
+                }
+
+                // item can move to freed slot only if its home slot isn't
+                // between freed slot and its current place
+                auto home = p_slots[next].hash & p_mask;
+                auto distance = (next - home) & p_mask;
+                auto gap = (next - index) & p_mask;
+                if (distance >= gap) {
+                    p_slots[index] = p_slots[next];
+                    index = next;
+                }
+            }
+
+            p_slots[index].item = nullptr;
+        }
+
+    private:
+        List    p_items;
+        Slot   *p_slots;
+        size_t  p_mask;
+        size_t  p_capacity;
+        size_t  p_hits;
+        size_t  p_misses;
+        size_t  p_evictions;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     ShardedLRUCache<T, K, keyT, intrusiveT>
+     -------------------------------------------------------------------------------
+         thread safe LRU cache split into independent shards, each shard is
+         LRUCache with its own lock, so threads which access different keys
+         rarely contend
+
+         capacity is divided evenly between shards, so recency is tracked
+         per shard and eviction is approximate LRU for the whole cache
+
+         found item is passed to callback while shard is locked, item must
+         not be used after callback returns because other thread could evict
+         it, items returned by Insert(), Remove() and Evict() are detached
+         and belong to caller
+    */
+
+    template <
+        typename T,
+        typename K = StringView,
+        typename keyT = LRUCacheDefaultAdapter<T, K>,
+        typename intrusiveT = IntrusiveListDefaultAdapter<T>
+    >
+    class ShardedLRUCache
+    {
+    public:
+        enum
+        {
+            DEFAULT_SHARDS = 16
+        };
+
+        using Cache = LRUCache<T, K, keyT, intrusiveT>;
+
+    public:
+        ShardedLRUCache(size_t capacity, size_t shards = DEFAULT_SHARDS) :
+            p_shards(nullptr),
+            p_count(c_util::umax(shards, size_t(1)))
+        {
+            p_shards = new Shard[p_count];
+
+            auto pershard = (capacity + p_count - 1) / p_count;
+            for (auto n = size_t(0); n < p_count; ++n) {
+                p_shards[n].cache.SetCapacity(pershard);
+            }
+        }
+
+        ShardedLRUCache(const ShardedLRUCache &) = delete;
+        ShardedLRUCache &operator=(const ShardedLRUCache &) = delete;
+
+        ~ShardedLRUCache()
+        {
+            delete[] p_shards;
+        }
+
+        size_t shards() const { return p_count; }
+
+        // calls found(T*) for found item, returns false if there's no item
+        template <typename F>
+        bool Find(const K &key, F found)
+        {
+            auto &shard = shardof(key);
+            std::lock_guard<std::mutex> guard(shard.lock);
+
+            auto item = shard.cache.Find(key);
+            if (item) {
+                found(item);
+            }
+
+            return item != nullptr;
+        }
+
+        T *Insert(T *item)
+        {
+            auto &shard = shardof(keyT::key(item));
+            std::lock_guard<std::mutex> guard(shard.lock);
+            return shard.cache.Insert(item);
+        }
+
+        T *Remove(const K &key)
+        {
+            auto &shard = shardof(key);
+            std::lock_guard<std::mutex> guard(shard.lock);
+            return shard.cache.Remove(key);
+        }
+
+        // evicts least recently used item of every shard into list
+        void Evict(IntrusiveList<T, intrusiveT> &evicted)
+        {
+            for (auto n = size_t(0); n < p_count; ++n) {
+                std::lock_guard<std::mutex> guard(p_shards[n].lock);
+                if (auto item = p_shards[n].cache.Evict()) {
+                    evicted.Add(item);
+                }
+            }
+        }
+
+        void Clear()
+        {
+            for (auto n = size_t(0); n < p_count; ++n) {
+                std::lock_guard<std::mutex> guard(p_shards[n].lock);
+                p_shards[n].cache.Clear();
+            }
+        }
+
+        size_t size() { return Sum(&Cache::size); }
+        size_t hits() { return Sum(&Cache::hits); }
+        size_t misses() { return Sum(&Cache::misses); }
+        size_t evictions() { return Sum(&Cache::evictions); }
+
+    private:
+        struct Shard
+        {
+            std::mutex lock;
+            Cache      cache;
+        };
+
+        Shard &shardof(const K &key)
+        {
+            // high half of hash, low bits are used by shard index
+            auto hash = Cache::hashof(key) >> (sizeof(size_t) * 4);
+            return p_shards[hash % p_count];
+        }
+
+        size_t Sum(size_t (Cache::*counter)() const)
+        {
+            auto result = size_t(0);
+            for (auto n = size_t(0); n < p_count; ++n) {
+                std::lock_guard<std::mutex> guard(p_shards[n].lock);
+                result += (p_shards[n].cache.*counter)();
+            }
+            return result;
+        }
+
+    private:
+        Shard  *p_shards;
+        size_t  p_count;
+    };
+}
@@ -0,0 +1,362 @@
+/*
+        memory stream implementations
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include "c_string.h"
+#include <cstring>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     MemoryStream
+     -------------------------------------------------------------------------------
+         stream over fixed block of memory
+
+         stream created from Span is read only (Read mode), stream created
+         from MutableSpan is ReadWrite stream, its size starts from given
+         initial size and could grow up to span size, writes beyond span
+         size are truncated
+
+         stream doesn't own memory block
+
+         readat() is thread safe, writeat() is thread safe for non overlapping
+         regions inside current size
+    */
+
+    class MemoryStream : public Stream
+    {
+    public:
+        MemoryStream() noexcept :
+            p_data(nullptr),
+            p_capacity(0),
+            p_size(0),
+            p_position(0),
+            p_mode(StreamMode::Closed)
+        {}
+
+        MemoryStream(const Span<unsigned char> &data) noexcept :
+            p_data(const_cast<unsigned char*>(data.data())),
+            p_capacity(data.size()),
+            p_size(data.size()),
+            p_position(0),
+            p_mode(StreamMode::Read)
+        {}
+
+        MemoryStream(const MutableSpan<unsigned char> &buffer, size_t size = 0) noexcept :
+            p_data(buffer.data()),
+            p_capacity(buffer.size()),
+            p_size(c_util::umin(size, buffer.size())),
+            p_position(0),
+            p_mode(StreamMode::ReadWrite)
+        {}
+
+        // stream contents
+        Span<unsigned char> data() const noexcept { return Span<unsigned char>(p_data, p_size); }
+        StringView text() const noexcept { return StringView(reinterpret_cast<const char*>(p_data), p_size); }
+
+        // stream contents starting from current position
+        Span<unsigned char> remaining() const noexcept { return data().slice(p_position); }
+
+        size_t capacity() const noexcept { return p_capacity; }
+
+        // streamT interface
+        size_t read(void *to, size_t size) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            size = adjustread(size, p_position, p_size);
+            memcpy(to, p_data + p_position, size);
+            p_position += size;
+
+            return size;
+        }
+
+        size_t write(const void *from, size_t size) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            size = c_util::umin(size, p_capacity - p_position);
+            Put(from, size);
+
+            return size;
+        }
+
+        size_t seek(size_t newpos, SeekOrigin origin = SeekOrigin::Begin) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            p_position = seekposition(newpos, origin, p_position, p_size);
+            return p_position;
+        }
+
+        StreamMode mode() const override { return p_mode; }
+        size_t position() const override { return p_position; }
+        size_t size() const override { return p_size; }
+
+        size_t readv(const Span<MutableSpan<unsigned char>> &buffers) override
+        {
+            if (p_mode == StreamMode::Closed) {
+                return 0;
+            }
+
+            auto total = size_t(0);
+            for (auto &buffer : buffers) {
+                auto amount = adjustread(buffer.size(), p_position, p_size);
+                memcpy(buffer.data(), p_data + p_position, amount);
+                p_position += amount;
+                total += amount;
+
+                if (amount < buffer.size()) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        size_t writev(const Span<Span<unsigned char>> &buffers) override
+        {
+            if (p_mode != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto total = size_t(0);
+            for (auto &buffer : buffers) {
+                auto amount = c_util::umin(buffer.size(), p_capacity - p_position);
+                Put(buffer.data(), amount);
+                total += amount;
+
+                if (amount < buffer.size()) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        size_t readat(void *to, size_t size, size_t offset) override
+        {
+            if (offset >= p_size) {
+                return 0;
+            }
+
+            size = adjustread(size, offset, p_size);
+            memcpy(to, p_data + offset, size);
+
+            return size;
+        }
+
+        size_t writeat(const void *from, size_t size, size_t offset) override
+        {
+            if (p_mode != StreamMode::ReadWrite || offset >= p_capacity) {
+                return 0;
+            }
+
+            size = c_util::umin(size, p_capacity - offset);
+            PutAt(from, size, offset);
+
+            return size;
+        }
+
+    protected:
+        // copies data at given offset, there should be enough room,
+        // gap between current size and offset is zero filled
+        void PutAt(const void *from, size_t size, size_t offset) noexcept
+        {
+            if (offset > p_size) {
+                memset(p_data + p_size, 0, offset - p_size);
+            }
+            memcpy(p_data + offset, from, size);
+            if ((offset + size) > p_size) {
+                p_size = offset + size;
+            }
+        }
+
+        // copies data at current position, there should be enough room
+        void Put(const void *from, size_t size) noexcept
+        {
+            if (p_position > p_size) {
+                memset(p_data + p_size, 0, p_position - p_size);
+            }
+            memcpy(p_data + p_position, from, size);
+            p_position += size;
+            p_size = c_util::umax(p_size, p_position);
+        }
+
+    protected:
+        unsigned char *p_data;
+        size_t         p_capacity;
+        size_t         p_size;
+        size_t         p_position;
+        StreamMode     p_mode;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     DynamicMemoryStream
+     -------------------------------------------------------------------------------
+         growable ReadWrite memory stream
+
+         stream owns its buffer, buffer grows geometrically when writing
+         beyond its capacity
+
+         written data could be moved out to String or MutableString without
+         copying (buffer is allocated as char array exactly for that),
+         stream becomes empty after that
+
+         any write which expands buffer could move data to other address,
+         pointers and views obtained before such write become invalid
+    */
+
+    class DynamicMemoryStream : public MemoryStream
+    {
+    public:
+        DynamicMemoryStream(size_t initialcapacity = 0)
+        {
+            p_mode = StreamMode::ReadWrite;
+            if (initialcapacity) {
+                Reserve(initialcapacity);
+            }
+        }
+
+        DynamicMemoryStream(const DynamicMemoryStream &) = delete;
+        DynamicMemoryStream &operator=(const DynamicMemoryStream &) = delete;
+
+        ~DynamicMemoryStream() override
+        {
+            delete[] reinterpret_cast<char*>(p_data);
+        }
+
+        void Reserve(size_t capacity)
+        {
+            if (capacity <= p_capacity) {
+                return;
+            }
+
+            auto newdata = new char[capacity];
+            if (p_size) {
+                memcpy(newdata, p_data, p_size);
+            }
+
+            delete[] reinterpret_cast<char*>(p_data);
+
+            p_data = reinterpret_cast<unsigned char*>(newdata);
+            p_capacity = capacity;
+        }
+
+        // drops stream contents, but keeps allocated buffer
+        void Clear() noexcept
+        {
+            p_size = 0;
+            p_position = 0;
+        }
+
+        template <typename N = StringExcludeNull>
+        StringBase<char, N> MoveToString()
+        {
+            if (p_size == 0) {
+                return StringBase<char, N>();
+            }
+
+            Reserve(p_size + N::NULL_LEN);
+            auto result = StringBase<char, N>::Adopt(TakeBuffer(), p_size);
+
+            Release();
+
+            return result;
+        }
+
+        template <typename N = StringExcludeNull>
+        MutableStringBase<char, N> MoveToMutableString()
+        {
+            if (p_size == 0) {
+                return MutableStringBase<char, N>();
+            }
+
+            Reserve(p_size + N::NULL_LEN);
+            auto result = MutableStringBase<char, N>::Adopt(TakeBuffer(), p_size, p_capacity);
+
+            Release();
+
+            return result;
+        }
+
+        // streamT interface
+        size_t write(const void *from, size_t size) override
+        {
+            auto end = p_position + size;
+            if (end > p_capacity) {
+                Reserve(c_util::umax(end, c_util::umax(p_capacity * 2, size_t(256))));
+            }
+
+            Put(from, size);
+
+            return size;
+        }
+
+        size_t writev(const Span<Span<unsigned char>> &buffers) override
+        {
+            // grow once for all buffers
+            auto total = size_t(0);
+            for (auto &buffer : buffers) {
+                total += buffer.size();
+            }
+
+            auto end = p_position + total;
+            if (end > p_capacity) {
+                Reserve(c_util::umax(end, c_util::umax(p_capacity * 2, size_t(256))));
+            }
+
+            for (auto &buffer : buffers) {
+                Put(buffer.data(), buffer.size());
+            }
+
+            return total;
+        }
+
+        // expanding writeat() reallocates buffer and isn't thread safe
+        size_t writeat(const void *from, size_t size, size_t offset) override
+        {
+            auto end = offset + size;
+            if (end > p_capacity) {
+                Reserve(c_util::umax(end, c_util::umax(p_capacity * 2, size_t(256))));
+            }
+
+            PutAt(from, size, offset);
+
+            return size;
+        }
+
+    private:
+        char *TakeBuffer() noexcept
+        {
+            return reinterpret_cast<char*>(p_data);
+        }
+
+        void Release() noexcept
+        {
+            p_data = nullptr;
+            p_capacity = 0;
+            p_size = 0;
+            p_position = 0;
+        }
+    };
+}
@@ -0,0 +1,139 @@
+/*
+        lock free intrusive multiple producer single consumer queue
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include <atomic>
+
+
+namespace c_common
+{
+    // links to be included into items of MPSCQueue
+    struct MPSCQueueLinks
+    {
+        MPSCQueueLinks() noexcept :
+            queuenext(nullptr)
+        {}
+
+        std::atomic<MPSCQueueLinks*> queuenext;
+    };
+
+
+    template <typename T>
+    class MPSCQueueDefaultAdapter
+    {
+    public:
+        static MPSCQueueLinks *links(T *item) { return item; }
+        static T *item(MPSCQueueLinks *links) { return static_cast<T*>(links); }
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     MPSCQueue<T, intrusiveT>
+     -------------------------------------------------------------------------------
+         intrusive FIFO queue, any number of threads may Push() items
+         concurrently, only one thread may Pop() them (D. Vyukov's algorithm)
+
+            struct Job : MPSCQueueLinks { ... };
+
+            MPSCQueue<Job> queue;
+            queue.Push(job);            // any thread
+            while (auto job = queue.Pop()) { ... } // consumer thread
+
+         Push() is wait free (single atomic exchange), Pop() is lock free,
+         Pop() may return nullptr while some producer is in the middle of
+         Push(), item becomes available right after that producer finishes,
+         so consumer should recheck queue after it's woken up rather than
+         treat nullptr as strict emptiness
+
+         like IntrusiveList, queue does not own or allocate items, item must
+         not be pushed again until it's popped
+    */
+
+    template <typename T, typename intrusiveT = MPSCQueueDefaultAdapter<T>>
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue() noexcept :
+            p_head(&p_stub),
+            p_tail(&p_stub)
+        {}
+
+        MPSCQueue(const MPSCQueue &) = delete;
+        MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+        // can be called from any thread
+        void Push(T *item) noexcept
+        {
+            Push(intrusiveT::links(item));
+        }
+
+        // consumer thread only, returns nullptr if there is nothing to pop
+        T *Pop() noexcept
+        {
+            auto tail = p_tail;
+            auto next = tail->queuenext.load(std::memory_order_acquire);
+
+            if (tail == &p_stub) {
+                if (next == nullptr) {
+                    return nullptr;
+                }
+
+                // skip stub
+                p_tail = next;
+                tail = next;
+                next = next->queuenext.load(std::memory_order_acquire);
+            }
+
+            if (next) {
+                p_tail = next;
+                return intrusiveT::item(tail);
+            }
+
+            // tail is last linked item, if it isn't head some producer
+            // swapped head but hasn't linked its item yet
+            if (tail != p_head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+
+            // put stub behind last item, so it could be detached
+            Push(&p_stub);
+
+            next = tail->queuenext.load(std::memory_order_acquire);
+            if (next) {
+                p_tail = next;
+                return intrusiveT::item(tail);
+            }
+
+            return nullptr;
+        }
+
+        // consumer thread only, true if there are no completely pushed items
+        bool empty() const noexcept
+        {
+            return p_tail == &p_stub && p_stub.queuenext.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        void Push(MPSCQueueLinks *links) noexcept
+        {
+            links->queuenext.store(nullptr, std::memory_order_relaxed);
+            auto prev = p_head.exchange(links, std::memory_order_acq_rel);
+            prev->queuenext.store(links, std::memory_order_release);
+        }
+
+    private:
+        // producers and consumer fields are kept on separate cache lines
+        alignas(64) std::atomic<MPSCQueueLinks*> p_head;
+        alignas(64) MPSCQueueLinks              *p_tail;
+        MPSCQueueLinks                           p_stub;
+    };
+}
@@ -0,0 +1,342 @@
+/*
+        slab based object pool for intrusive list nodes
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_util.h"
+#include "c_intrusivelist.h"
+#include <mutex>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     ObjectPool<T, intrusiveT>
+     -------------------------------------------------------------------------------
+         pool of reusable objects which carry IntrusiveList links
+
+         objects are created by slabs of slabsize objects laid out
+         contiguously, free objects are kept in IntrusiveList threaded
+         through their own links, so Acquire() and Release() are O(1) and
+         don't touch memory allocator after warm up
+
+            struct Node : IntrusiveList<Node>::Links { ... };
+
+            ObjectPool<Node> pool;
+            IntrusiveList<Node> list;
+
+            auto node = pool.Acquire();
+            list.Add(node);
+            ...
+            pool.Recycle(list, node); // removes from list and releases
+
+         objects are default constructed when slab is created and destroyed
+         together with the pool, released object keeps its state, Acquire()
+         returns it as is, so caller reinitializes object if needed
+
+         released object must not be in any list, all objects must be
+         released to the pool they were acquired from
+
+         pool isn't thread safe, see SharedObjectPool
+    */
+
+    template <typename T, typename intrusiveT = IntrusiveListDefaultAdapter<T>>
+    class ObjectPool
+    {
+    public:
+        enum
+        {
+            DEFAULT_SLAB_SIZE = 64
+        };
+
+        using List = IntrusiveList<T, intrusiveT>;
+
+    public:
+        ObjectPool(size_t slabsize = DEFAULT_SLAB_SIZE) :
+            p_slabs(nullptr),
+            p_slabsize(c_util::umax(slabsize, size_t(1))),
+            p_count(0)
+        {}
+
+        ObjectPool(const ObjectPool &) = delete;
+        ObjectPool &operator=(const ObjectPool &) = delete;
+
+        ~ObjectPool()
+        {
+            while (p_slabs) {
+                auto slab = p_slabs;
+                p_slabs = slab->next;
+                delete[] slab->items;
+                delete slab;
+            }
+        }
+
+        // objects created by the pool
+        size_t size() const { return p_count; }
+
+        // objects ready to be acquired without allocation
+        size_t available() const { return p_free.size(); }
+
+        size_t slabsize() const { return p_slabsize; }
+
+        T *Acquire()
+        {
+            if (p_free.size() == 0) {
+                AddSlab();
+            }
+
+            auto item = p_free.back();
+            p_free.Remove(item);
+
+            return item;
+        }
+
+        void Release(T *item)
+        {
+#if _DEBUG && defined(_CrtDbgBreak)
+            if (!owns(item)) {
+                _CrtDbgBreak();
+            }
+#endif
+            p_free.Add(item);
+        }
+
+        // removes item from list and releases it
+        void Recycle(List &list, T *item)
+        {
+            list.Remove(item);
+            Release(item);
+        }
+
+        // moves count objects to list
+        void Acquire(List &list, size_t count)
+        {
+            for (auto n = size_t(0); n < count; ++n) {
+                list.Add(Acquire());
+            }
+        }
+
+        // releases all objects of list, list becomes empty
+        void ReleaseAll(List &list)
+        {
+            p_free.Splice(list);
+        }
+
+        // creates objects in advance so count objects are available
+        void Reserve(size_t count)
+        {
+            while (p_free.size() < count) {
+                AddSlab();
+            }
+        }
+
+        // checks if item belongs to one of pool slabs
+        bool owns(const T *item) const
+        {
+            for (auto slab = p_slabs; slab; slab = slab->next) {
+                if (item >= slab->items && item < slab->items + p_slabsize) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        struct Slab
+        {
+            Slab *next;
+            T    *items;
+        };
+
+        void AddSlab()
+        {
+            auto slab = new Slab;
+            slab->items = new T[p_slabsize];
+            slab->next = p_slabs;
+            p_slabs = slab;
+
+            p_count += p_slabsize;
+
+            // reversed, so Acquire() hands out objects in memory order
+            for (auto n = p_slabsize; n > 0; --n) {
+                p_free.Add(slab->items + n - 1);
+            }
+        }
+
+    private:
+        List    p_free;
+        Slab   *p_slabs;
+        size_t  p_slabsize;
+        size_t  p_count;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     SharedObjectPool<T, intrusiveT>
+     -------------------------------------------------------------------------------
+         thread safe ObjectPool, every call locks the pool
+
+         threads which acquire and release objects frequently use Cache,
+         cache keeps small list of objects and exchanges them with shared
+         pool by batches, so lock is taken once per batch
+
+            SharedObjectPool<Node> pool;
+
+            // on every worker thread
+            SharedObjectPool<Node>::Cache cache(pool);
+            auto node = cache.Acquire();
+            ...
+            cache.Release(node);
+
+         object acquired through one cache could be released through other
+         one, cache returns its objects to the pool when destroyed, cache
+         itself must be used by single thread
+    */
+
+    template <typename T, typename intrusiveT = IntrusiveListDefaultAdapter<T>>
+    class SharedObjectPool
+    {
+    public:
+        enum
+        {
+            DEFAULT_BATCH = 32
+        };
+
+        using List = IntrusiveList<T, intrusiveT>;
+
+        class Cache
+        {
+        public:
+            Cache(SharedObjectPool<T, intrusiveT> &pool, size_t batch = DEFAULT_BATCH) :
+                p_pool(pool),
+                p_batch(c_util::umax(batch, size_t(1)))
+            {}
+
+            Cache(const Cache &) = delete;
+            Cache &operator=(const Cache &) = delete;
+
+            ~Cache()
+            {
+                Flush();
+            }
+
+            size_t cached() const { return p_items.size(); }
+
+            T *Acquire()
+            {
+                if (p_items.size() == 0) {
+                    p_pool.Acquire(p_items, p_batch);
+                }
+
+                auto item = p_items.back();
+                p_items.Remove(item);
+
+                return item;
+            }
+
+            void Release(T *item)
+            {
+                p_items.Add(item);
+
+                // keep one batch, give the rest back
+                if (p_items.size() >= p_batch * 2) {
+                    List excess;
+                    while (p_items.size() > p_batch) {
+                        auto last = p_items.back();
+                        p_items.Remove(last);
+                        excess.Add(last);
+                    }
+                    p_pool.ReleaseAll(excess);
+                }
+            }
+
+            void Recycle(List &list, T *item)
+            {
+                list.Remove(item);
+                Release(item);
+            }
+
+            // returns all cached objects to the pool
+            void Flush()
+            {
+                if (p_items.size()) {
+                    p_pool.ReleaseAll(p_items);
+                }
+            }
+
+        private:
+            SharedObjectPool<T, intrusiveT> &p_pool;
+            List                             p_items;
+            size_t                           p_batch;
+        };
+
+    public:
+        SharedObjectPool(size_t slabsize = ObjectPool<T, intrusiveT>::DEFAULT_SLAB_SIZE) :
+            p_pool(slabsize)
+        {}
+
+        SharedObjectPool(const SharedObjectPool &) = delete;
+        SharedObjectPool &operator=(const SharedObjectPool &) = delete;
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            return p_pool.size();
+        }
+
+        size_t available()
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            return p_pool.available();
+        }
+
+        T *Acquire()
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            return p_pool.Acquire();
+        }
+
+        void Release(T *item)
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            p_pool.Release(item);
+        }
+
+        void Recycle(List &list, T *item)
+        {
+            list.Remove(item);
+            Release(item);
+        }
+
+        void Acquire(List &list, size_t count)
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            p_pool.Acquire(list, count);
+        }
+
+        void ReleaseAll(List &list)
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            p_pool.ReleaseAll(list);
+        }
+
+        void Reserve(size_t count)
+        {
+            std::lock_guard<std::mutex> guard(p_lock);
+            p_pool.Reserve(count);
+        }
+
+    private:
+        std::mutex                 p_lock;
+        ObjectPool<T, intrusiveT>  p_pool;
+    };
+}
@@ -0,0 +1,517 @@
+/*
+        pipe and socket stream implementation (POSIX)
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     PipeStream
+     -------------------------------------------------------------------------------
+         stream over pipe, unix socket or any other descriptor without
+         position (terminal, fifo, stream socket)
+
+         supported modes:
+            StreamRead      - read end of pipe
+            StreamWrite     - write end of pipe
+            StreamReadWrite - socket
+
+         in blocking mode read() waits until some data is available and
+         returns what single system call gave (like plain pipe read), so
+         readers with large buffers don't stall on interactive protocols,
+         ReadFully() waits for whole requested size, it returns less only
+         when peer closed its end (eof() becomes true) or on error, write()
+         always transfers whole requested size
+
+         in non blocking mode read() and write() transfer as much as could
+         be transferred without waiting, if transfer stopped because it
+         would block wouldblock() is true until next transfer call, use
+         StreamPoller to wait for readiness
+
+         writing to pipe which has no readers raises SIGPIPE unless it's
+         ignored by application, sockets are written with MSG_NOSIGNAL
+
+         position() and size() are not defined for stream modes, they
+         return 0
+    */
+
+    class PipeStream : public Stream
+    {
+    public:
+        enum
+        {
+            IOV_BATCH = 64 // max buffers passed to single vectored call
+        };
+
+    public:
+        PipeStream() noexcept :
+            p_handle(-1),
+            p_mode(StreamMode::Closed),
+            p_own(false),
+            p_socket(false),
+            p_nonblocking(false),
+            p_wouldblock(false),
+            p_eof(false)
+        {}
+
+        PipeStream(int handle, StreamMode mode, bool own = true) noexcept :
+            PipeStream()
+        {
+            Attach(handle, mode, own);
+        }
+
+        PipeStream(const PipeStream &) = delete;
+        PipeStream &operator=(const PipeStream &) = delete;
+
+        ~PipeStream() override
+        {
+            Close();
+        }
+
+        // attaches existing descriptor, if own is true it's closed by stream
+        bool Attach(int handle, StreamMode mode, bool own = true) noexcept
+        {
+            Close();
+
+            if (handle < 0 || (
+                mode != StreamMode::StreamRead &&
+                mode != StreamMode::StreamWrite &&
+                mode != StreamMode::StreamReadWrite)) {
+                return false;
+            }
+
+            int type;
+            socklen_t length = sizeof(type);
+
+            p_handle = handle;
+            p_mode = mode;
+            p_own = own;
+            p_socket = getsockopt(handle, SOL_SOCKET, SO_TYPE, &type, &length) == 0;
+            p_nonblocking = (fcntl(handle, F_GETFL) & O_NONBLOCK) != 0;
+
+            return true;
+        }
+
+        void Close() noexcept
+        {
+            if (p_handle >= 0 && p_own) {
+                ::close(p_handle);
+            }
+
+            p_handle = -1;
+            p_mode = StreamMode::Closed;
+            p_own = false;
+            p_socket = false;
+            p_nonblocking = false;
+            p_wouldblock = false;
+            p_eof = false;
+        }
+
+        // creates pipe, read end is StreamRead, write end is StreamWrite
+        static bool CreatePipe(PipeStream &readend, PipeStream &writeend) noexcept
+        {
+            int handles[2];
+            if (pipe2(handles, O_CLOEXEC) != 0) {
+                return false;
+            }
+
+            readend.Attach(handles[0], StreamMode::StreamRead);
+            writeend.Attach(handles[1], StreamMode::StreamWrite);
+
+            return true;
+        }
+
+        // creates pair of connected unix sockets, both are StreamReadWrite
+        static bool CreateSocketPair(PipeStream &first, PipeStream &second) noexcept
+        {
+            int handles[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, handles) != 0) {
+                return false;
+            }
+
+            first.Attach(handles[0], StreamMode::StreamReadWrite);
+            second.Attach(handles[1], StreamMode::StreamReadWrite);
+
+            return true;
+        }
+
+        bool SetNonBlocking(bool nonblocking) noexcept
+        {
+            if (p_handle < 0) {
+                return false;
+            }
+
+            auto flags = fcntl(p_handle, F_GETFL);
+            if (flags < 0) {
+                return false;
+            }
+
+            flags = nonblocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK;
+            if (fcntl(p_handle, F_SETFL, flags) != 0) {
+                return false;
+            }
+
+            p_nonblocking = nonblocking;
+            return true;
+        }
+
+        // closes writing direction of socket, peer reads eof after that
+        bool ShutdownWrite() noexcept
+        {
+            if (!p_socket || p_mode != StreamMode::StreamReadWrite) {
+                return false;
+            }
+
+            if (shutdown(p_handle, SHUT_WR) != 0) {
+                return false;
+            }
+
+            p_mode = StreamMode::StreamRead;
+            return true;
+        }
+
+        // underlying descriptor, -1 if stream is closed
+        int handle() const noexcept { return p_handle; }
+
+        bool nonblocking() const noexcept { return p_nonblocking; }
+
+        // last transfer stopped because descriptor wasn't ready
+        bool wouldblock() const noexcept { return p_wouldblock; }
+
+        // peer closed its end, there will be no more data to read
+        bool eof() const noexcept { return p_eof; }
+
+        // streamT interface
+        size_t read(void *to, size_t size) override
+        {
+            p_wouldblock = false;
+            if (!canread()) {
+                return 0;
+            }
+
+            auto dest = static_cast<char*>(to);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto amount = ::read(p_handle, dest + total, size - total);
+                if (amount > 0) {
+                    total += size_t(amount);
+                    // blocking read doesn't wait for more than it got
+                    if (!p_nonblocking) {
+                        break;
+                    }
+                    continue;
+                }
+
+                if (amount == 0) {
+                    p_eof = true;
+                    break;
+                }
+
+                if (!Retry()) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        size_t write(const void *from, size_t size) override
+        {
+            p_wouldblock = false;
+            if (!canwrite()) {
+                return 0;
+            }
+
+            auto source = static_cast<const char*>(from);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto amount = p_socket ?
+                    ::send(p_handle, source + total, size - total, MSG_NOSIGNAL) :
+                    ::write(p_handle, source + total, size - total);
+                if (amount < 0) {
+                    if (Retry()) {
+                        continue;
+                    }
+                    break;
+                }
+                total += size_t(amount);
+            }
+
+            return total;
+        }
+
+        size_t seek(size_t, SeekOrigin = SeekOrigin::Begin) override
+        {
+            return 0;
+        }
+
+        StreamMode mode() const override { return p_mode; }
+        size_t position() const override { return 0; }
+        size_t size() const override { return 0; }
+
+        size_t readv(const Span<MutableSpan<unsigned char>> &buffers) override
+        {
+            p_wouldblock = false;
+            if (!canread()) {
+                return 0;
+            }
+
+            return Transfer(buffers.data(), buffers.size(), false);
+        }
+
+        size_t writev(const Span<Span<unsigned char>> &buffers) override
+        {
+            p_wouldblock = false;
+            if (!canwrite()) {
+                return 0;
+            }
+
+            return Transfer(buffers.data(), buffers.size(), true);
+        }
+
+        // reads whole requested size, returns less on eof, error or when
+        // non blocking read would block
+        size_t ReadFully(void *to, size_t size)
+        {
+            auto dest = static_cast<char*>(to);
+            auto total = size_t(0);
+
+            while (total < size) {
+                auto amount = read(dest + total, size - total);
+                if (amount == 0) {
+                    break;
+                }
+                total += amount;
+            }
+
+            return total;
+        }
+
+    private:
+        bool canread() const
+        {
+            return (p_mode == StreamMode::StreamRead || p_mode == StreamMode::StreamReadWrite) && !p_eof;
+        }
+
+        bool canwrite() const
+        {
+            return p_mode == StreamMode::StreamWrite || p_mode == StreamMode::StreamReadWrite;
+        }
+
+        // checks failed call error, returns true if call should be repeated
+        bool Retry()
+        {
+            if (errno == EINTR) {
+                return true;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                p_wouldblock = true;
+            }
+
+            return false;
+        }
+
+        template <typename B>
+        size_t Transfer(B *buffers, size_t count, bool write)
+        {
+            iovec vectors[IOV_BATCH];
+            auto total = size_t(0);
+
+            auto index = size_t(0);
+            auto offset = size_t(0); // already transferred part of buffers[index]
+
+            while (index < count) {
+                auto batch = size_t(0);
+                auto requested = size_t(0);
+                for (auto n = index; n < count && batch < IOV_BATCH; ++n, ++batch) {
+                    auto skip = n == index ? offset : 0;
+                    vectors[batch].iov_base = const_cast<unsigned char*>(buffers[n].data()) + skip;
+                    vectors[batch].iov_len = buffers[n].size() - skip;
+                    requested += vectors[batch].iov_len;
+                }
+
+                // empty buffers only, zero result wouldn't mean eof
+                if (requested == 0) {
+                    index += batch;
+                    offset = 0;
+                    continue;
+                }
+
+                ssize_t amount;
+                if (write && p_socket) {
+                    msghdr message = {};
+                    message.msg_iov = vectors;
+                    message.msg_iovlen = batch;
+                    amount = ::sendmsg(p_handle, &message, MSG_NOSIGNAL);
+                } else {
+                    amount = write ? ::writev(p_handle, vectors, int(batch)) : ::readv(p_handle, vectors, int(batch));
+                }
+
+                if (amount == 0) {
+                    p_eof = !write;
+                    break;
+                }
+
+                if (amount < 0) {
+                    if (Retry()) {
+                        continue;
+                    }
+                    break;
+                }
+
+                total += size_t(amount);
+
+                // blocking read doesn't wait for more than it got
+                if (!write && !p_nonblocking) {
+                    break;
+                }
+
+                // advance over transferred buffers
+                auto left = size_t(amount);
+                while (index < count && left >= buffers[index].size() - offset) {
+                    left -= buffers[index].size() - offset;
+                    offset = 0;
+                    ++index;
+                }
+                offset += left;
+            }
+
+            return total;
+        }
+
+    private:
+        int        p_handle;
+        StreamMode p_mode;
+        bool       p_own;
+        bool       p_socket;
+        bool       p_nonblocking;
+        bool       p_wouldblock;
+        bool       p_eof;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     StreamPoller
+     -------------------------------------------------------------------------------
+         epoll based readiness helper for non blocking PipeStream objects
+
+         streams are registered with set of events of interest and context
+         pointer (stream itself by default), Wait() fills array of ready
+         events with context and events which happened
+
+         polling is level triggered, stream stays ready until all available
+         data is read (or while there is room for writing)
+
+         poller doesn't own streams, stream must be removed before it's closed
+    */
+
+    struct PollEvent
+    {
+        void     *context;
+        unsigned  events;
+    };
+
+    class StreamPoller
+    {
+    public:
+        enum
+        {
+            POLL_READ   = 1,
+            POLL_WRITE  = 2,
+            POLL_HANGUP = 4, // peer closed or error, reported regardless of mask
+        };
+
+    public:
+        StreamPoller() noexcept :
+            p_handle(epoll_create1(EPOLL_CLOEXEC))
+        {}
+
+        StreamPoller(const StreamPoller &) = delete;
+        StreamPoller &operator=(const StreamPoller &) = delete;
+
+        ~StreamPoller()
+        {
+            if (p_handle >= 0) {
+                ::close(p_handle);
+            }
+        }
+
+        bool valid() const noexcept { return p_handle >= 0; }
+
+        bool Add(const PipeStream &stream, unsigned events, void *context = nullptr) noexcept
+        {
+            return Control(EPOLL_CTL_ADD, stream, events, context);
+        }
+
+        bool Modify(const PipeStream &stream, unsigned events, void *context = nullptr) noexcept
+        {
+            return Control(EPOLL_CTL_MOD, stream, events, context);
+        }
+
+        bool Remove(const PipeStream &stream) noexcept
+        {
+            return epoll_ctl(p_handle, EPOLL_CTL_DEL, stream.handle(), nullptr) == 0;
+        }
+
+        // waits for events, timeout in milliseconds (-1 waits forever),
+        // returns number of ready events or -1 on error
+        int Wait(PollEvent *events, int maxevents, int timeout = -1) noexcept
+        {
+            enum { BATCH = 64 };
+
+            epoll_event ready[BATCH];
+
+            int count;
+            do {
+                count = epoll_wait(p_handle, ready, maxevents < BATCH ? maxevents : int(BATCH), timeout);
+            } while (count < 0 && errno == EINTR);
+
+            for (auto n = 0; n < count; ++n) {
+                auto flags = ready[n].events;
+                events[n].context = ready[n].data.ptr;
+                events[n].events =
+                    (flags & EPOLLIN ? unsigned(POLL_READ) : 0u) |
+                    (flags & EPOLLOUT ? unsigned(POLL_WRITE) : 0u) |
+                    (flags & (EPOLLHUP | EPOLLRDHUP | EPOLLERR) ? unsigned(POLL_HANGUP) : 0u);
+            }
+
+            return count;
+        }
+
+    private:
+        bool Control(int operation, const PipeStream &stream, unsigned events, void *context) noexcept
+        {
+            epoll_event event = {};
+            event.events =
+                (events & POLL_READ ? unsigned(EPOLLIN | EPOLLRDHUP) : 0u) |
+                (events & POLL_WRITE ? unsigned(EPOLLOUT) : 0u);
+            event.data.ptr = context ? context : const_cast<PipeStream*>(&stream);
+
+            return epoll_ctl(p_handle, operation, stream.handle(), &event) == 0;
+        }
+
+    private:
+        int p_handle;
+    };
+}
@@ -0,0 +1,386 @@
+/*
+        dynamic array with inline storage
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_util.h"
+#include "c_span.h"
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace c_common
+{
+    // tells if objects of type could be moved to other address with plain
+    // memory copy (old copy is not destroyed after that), it's true for
+    // trivially copyable types, specialize it for types which don't have
+    // pointers to themselves (like StringBase) to speed up SmallVector
+    template <typename T>
+    struct SmallVectorRelocatable
+    {
+        static constexpr bool value = std::is_trivially_copyable<T>::value;
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     SmallVector<T, N>
+     -------------------------------------------------------------------------------
+         dynamic array which keeps up to N items inside itself, memory is
+         allocated only when array grows larger, then capacity grows twice
+
+            SmallVector<vec3f, 8> points;
+            points.Add(vec3f(0, 0, 0));
+            Process(points); // takes Span<vec3f>
+
+         array converts to Span and MutableSpan, so it could be passed to
+         any function which accepts span
+
+         items of relocatable types (see SmallVectorRelocatable) are moved
+         with memcpy()/memmove() when array grows or items are inserted or
+         removed, other types are moved with move constructor and assignment
+
+         pointers to items are invalidated when array grows, moving array
+         with inline items moves items as well
+    */
+
+    template <typename T, size_t N>
+    class SmallVector
+    {
+        static_assert(N > 0, "inline capacity must not be zero");
+
+    public:
+        using value_type = T;
+
+    public:
+        SmallVector() noexcept :
+            p_data(inlinedata()),
+            p_size(0),
+            p_capacity(N)
+        {}
+
+        explicit SmallVector(size_t count) :
+            SmallVector()
+        {
+            Resize(count);
+        }
+
+        SmallVector(const std::initializer_list<T> &source) :
+            SmallVector()
+        {
+            Append(Span<T>(source));
+        }
+
+        template <typename M>
+        SmallVector(const Span<T, M> &source) :
+            SmallVector()
+        {
+            Append(source);
+        }
+
+        SmallVector(const SmallVector<T, N> &source) :
+            SmallVector()
+        {
+            Append(Span<T>(source));
+        }
+
+        SmallVector(SmallVector<T, N> &&source) noexcept :
+            SmallVector()
+        {
+            Take(source);
+        }
+
+        ~SmallVector()
+        {
+            Clear();
+            FreeStorage();
+        }
+
+        SmallVector<T, N> &operator=(const SmallVector<T, N> &source)
+        {
+            if (&source != this) {
+                Clear();
+                Append(Span<T>(source));
+            }
+            return *this;
+        }
+
+        SmallVector<T, N> &operator=(SmallVector<T, N> &&source) noexcept
+        {
+            if (&source != this) {
+                Clear();
+                FreeStorage();
+                Take(source);
+            }
+            return *this;
+        }
+
+        operator Span<T>() const noexcept { return Span<T>(p_data, p_size); }
+        operator MutableSpan<T>() noexcept { return MutableSpan<T>(p_data, p_size); }
+
+        T *begin() noexcept { return p_data; }
+        T *end() noexcept { return p_data + p_size; }
+        const T *begin() const noexcept { return p_data; }
+        const T *end() const noexcept { return p_data + p_size; }
+
+        T *data() noexcept { return p_data; }
+        const T *data() const noexcept { return p_data; }
+
+        bool empty() const noexcept { return p_size == 0; }
+        size_t size() const noexcept { return p_size; }
+        size_t capacity() const noexcept { return p_capacity; }
+
+        // items are kept in inline storage
+        bool inlined() const noexcept { return p_data == inlinedata(); }
+
+        T &operator[](size_t index) { assert(index < p_size); return p_data[index]; }
+        const T &operator[](size_t index) const { assert(index < p_size); return p_data[index]; }
+        T &front() { assert(p_size); return p_data[0]; }
+        const T &front() const { assert(p_size); return p_data[0]; }
+        T &back() { assert(p_size); return p_data[p_size - 1]; }
+        const T &back() const { assert(p_size); return p_data[p_size - 1]; }
+
+        void Add(const T &item)
+        {
+            Emplace(item);
+        }
+
+        void Add(T &&item)
+        {
+            Emplace(std::move(item));
+        }
+
+        template <typename... A>
+        T &Emplace(A&&... args)
+        {
+            if (p_size == p_capacity) {
+                // argument could refer to item of this array, so it's
+                // constructed before old items are released
+                auto capacity = grown(p_size + 1);
+                auto storage = Allocate(capacity);
+                new (storage + p_size) T(std::forward<A>(args)...);
+                Relocate(storage, p_data, p_size);
+                Replace(storage, capacity);
+            } else {
+                new (p_data + p_size) T(std::forward<A>(args)...);
+            }
+
+            return p_data[p_size++];
+        }
+
+        template <typename M>
+        void Append(const Span<T, M> &items)
+        {
+            auto count = items.size();
+            if (p_size + count > p_capacity) {
+                // items could be part of this array, like in Emplace() they
+                // are copied before old items are released
+                auto capacity = grown(p_size + count);
+                auto storage = Allocate(capacity);
+                auto to = storage + p_size;
+                for (auto &item : items) {
+                    new (to++) T(item);
+                }
+                Relocate(storage, p_data, p_size);
+                Replace(storage, capacity);
+                p_size += count;
+                return;
+            }
+
+            for (auto &item : items) {
+                new (p_data + p_size) T(item);
+                ++p_size;
+            }
+        }
+
+        void Insert(size_t index, T item)
+        {
+            assert(index <= p_size);
+
+            Reserve(p_size + 1);
+
+            auto position = p_data + index;
+            if (index == p_size) {
+                new (position) T(std::move(item));
+            } else if constexpr (SmallVectorRelocatable<T>::value) {
+                memmove(static_cast<void*>(position + 1), position, (p_size - index) * sizeof(T));
+                new (position) T(std::move(item));
+            } else {
+                new (p_data + p_size) T(std::move(p_data[p_size - 1]));
+                for (auto n = p_size - 1; n > index; --n) {
+                    p_data[n] = std::move(p_data[n - 1]);
+                }
+                *position = std::move(item);
+            }
+
+            ++p_size;
+        }
+
+        // removes count items starting from index
+        void Remove(size_t index, size_t count = 1)
+        {
+            assert(index <= p_size && count <= p_size - index);
+
+            auto tail = p_size - index - count;
+
+            if constexpr (SmallVectorRelocatable<T>::value) {
+                Destroy(p_data + index, count);
+                memmove(static_cast<void*>(p_data + index), p_data + index + count, tail * sizeof(T));
+            } else {
+                for (auto n = size_t(0); n < tail; ++n) {
+                    p_data[index + n] = std::move(p_data[index + count + n]);
+                }
+                Destroy(p_data + index + tail, count);
+            }
+
+            p_size -= count;
+        }
+
+        void RemoveLast()
+        {
+            assert(p_size);
+            Destroy(p_data + --p_size, 1);
+        }
+
+        // destroys all items, allocated memory is kept
+        void Clear()
+        {
+            Destroy(p_data, p_size);
+            p_size = 0;
+        }
+
+        void Reserve(size_t count)
+        {
+            if (count > p_capacity) {
+                auto capacity = grown(count);
+                auto storage = Allocate(capacity);
+                Relocate(storage, p_data, p_size);
+                Replace(storage, capacity);
+            }
+        }
+
+        // new items are value initialized
+        void Resize(size_t count)
+        {
+            if (count < p_size) {
+                Destroy(p_data + count, p_size - count);
+                p_size = count;
+                return;
+            }
+
+            Reserve(count);
+            while (p_size < count) {
+                new (p_data + p_size) T();
+                ++p_size;
+            }
+        }
+
+        // moves items back to inline storage or to smaller allocation
+        void ShrinkToFit()
+        {
+            if (inlined() || p_size == p_capacity) {
+                return;
+            }
+
+            if (p_size <= N) {
+                Relocate(inlinedata(), p_data, p_size);
+                Replace(inlinedata(), N);
+            } else {
+                auto storage = Allocate(p_size);
+                Relocate(storage, p_data, p_size);
+                Replace(storage, p_size);
+            }
+        }
+
+    private:
+        T *inlinedata() noexcept { return reinterpret_cast<T*>(p_inline); }
+        const T *inlinedata() const noexcept { return reinterpret_cast<const T*>(p_inline); }
+
+        size_t grown(size_t required) const noexcept
+        {
+            return c_util::umax(p_capacity * 2, required);
+        }
+
+        static T *Allocate(size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+        }
+
+        static void Destroy(T *items, size_t count) noexcept
+        {
+            if constexpr (!std::is_trivially_destructible<T>::value) {
+                for (auto n = size_t(0); n < count; ++n) {
+                    items[n].~T();
+                }
+            }
+        }
+
+        // moves items to uninitialized memory, source items are released
+        static void Relocate(T *to, T *from, size_t count) noexcept
+        {
+            if constexpr (SmallVectorRelocatable<T>::value) {
+                if (count) {
+                    memcpy(static_cast<void*>(to), from, count * sizeof(T));
+                }
+            } else {
+                for (auto n = size_t(0); n < count; ++n) {
+                    new (to + n) T(std::move(from[n]));
+                    from[n].~T();
+                }
+            }
+        }
+
+        // switches to other storage with relocated items
+        void Replace(T *storage, size_t capacity) noexcept
+        {
+            FreeStorage();
+            p_data = storage;
+            p_capacity = capacity;
+        }
+
+        void FreeStorage() noexcept
+        {
+            if (!inlined()) {
+                ::operator delete(p_data, std::align_val_t(alignof(T)));
+                p_data = inlinedata();
+                p_capacity = N;
+            }
+        }
+
+        // takes items of source, this array must be empty and inlined
+        void Take(SmallVector<T, N> &source) noexcept
+        {
+            if (source.inlined()) {
+                Relocate(p_data, source.p_data, source.p_size);
+                p_size = source.p_size;
+            } else {
+                p_data = source.p_data;
+                p_size = source.p_size;
+                p_capacity = source.p_capacity;
+
+                source.p_data = source.inlinedata();
+                source.p_capacity = N;
+            }
+
+            source.p_size = 0;
+        }
+
+    private:
+        T      *p_data;
+        size_t  p_size;
+        size_t  p_capacity;
+
+        alignas(T) unsigned char p_inline[N * sizeof(T)];
+    };
+}
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "c_util.h"
+#include "c_span.h"
 
 
 namespace c_common
@@ -212,6 +213,37 @@ namespace c_common
                     in general read beyond the stream size is not allowed
                     write beyond stream size could expand stream, but also could be prohibited
 
+         scatter/gather interface functions are:
+            readv()    - reads data from stream into several buffers
+                buffers - list of buffers, filled in order
+                result  - actual data size read from stream
+
+            writev()   - writes data from several buffers to stream
+                buffers - list of buffers, written in order
+                result  - actual data size written to stream
+
+                these calls behave exactly like sequence of read()/write() calls
+                for every buffer which stops at first incomplete transfer, default
+                implementation does just that, streams override them to transfer
+                all buffers at once (single system call or memory copy loop without
+                virtual calls)
+
+         positional interface functions are:
+            readat()   - reads data from given position
+            writeat()  - writes data at given position
+                offset  - absolute position inside stream
+                result  - actual data size read/written
+
+                these calls are valid only for Read and ReadWrite modes (writeat()
+                only for ReadWrite), they don't use and don't change current
+                position, so implementations make them safe to call from several
+                threads at once, which allows to read single stream in parallel
+                writeat() is thread safe only for non overlapping regions and only
+                if it doesn't expand the stream
+
+                default implementation emulates them with seek() and restores
+                position afterwards, such emulation is NOT thread safe
+
          T - defines basic data type for stream position and size
     */
     template <typename T>
@@ -228,6 +260,69 @@ namespace c_common
         virtual T position() const = 0;
         virtual T size() const = 0;
 
+        // scatter/gather interface
+        virtual T readv(const Span<MutableSpan<unsigned char>> &buffers)
+        {
+            auto total = T(0);
+
+            for (auto &buffer : buffers) {
+                auto amount = read(buffer.data(), T(buffer.size()));
+                total += amount;
+
+                if (amount < T(buffer.size())) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        virtual T writev(const Span<Span<unsigned char>> &buffers)
+        {
+            auto total = T(0);
+
+            for (auto &buffer : buffers) {
+                auto amount = write(buffer.data(), T(buffer.size()));
+                total += amount;
+
+                if (amount < T(buffer.size())) {
+                    break;
+                }
+            }
+
+            return total;
+        }
+
+        // positional interface
+        virtual T readat(void *to, T size, T offset)
+        {
+            auto m = mode();
+            if (m != StreamMode::Read && m != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto current = position();
+            seek(offset);
+            auto result = read(to, size);
+            seek(current);
+
+            return result;
+        }
+
+        virtual T writeat(const void *from, T size, T offset)
+        {
+            if (mode() != StreamMode::ReadWrite) {
+                return 0;
+            }
+
+            auto current = position();
+            seek(offset);
+            auto result = write(from, size);
+            seek(current);
+
+            return result;
+        }
+
     protected:
         // utility functions
         static T adjustread(T readamount, T position, T size)
@@ -0,0 +1,355 @@
+/*
+        stream to stream data transfer
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stream.h"
+#include "c_filestream.h"
+#include "c_memorystream.h"
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include "c_pipestream.h"
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     StreamCopier
+     -------------------------------------------------------------------------------
+         copies data from one stream to another picking fastest available way:
+
+            Memory        - source is MemoryStream or MappedFileStream, its
+                            memory is written to destination with single write
+            CopyFileRange - both streams are FileStream objects, data is
+                            copied inside kernel (or by filesystem itself)
+            SendFile      - source is FileStream and destination is pipe or
+                            socket
+            Splice        - source or destination is blocking PipeStream over
+                            pipe, other end is FileStream or PipeStream
+            Buffered      - any other streams, data is read in chunks by
+                            helper thread while previous chunk is written,
+                            so reading and writing overlap
+
+         kernel ways are used only on Linux, they fall back to next suitable
+         way when kernel or filesystem doesn't support them, positions of
+         FileStream objects are updated as if data were transferred by
+         read()/write()
+
+         source and destination must be different objects
+    */
+
+    class StreamCopier
+    {
+    public:
+        enum : size_t
+        {
+            COPY_ALL = size_t(-1) // copy until source end
+        };
+
+        enum class CopyMethod
+        {
+            None,
+            Memory,
+            CopyFileRange,
+            SendFile,
+            Splice,
+            Buffered
+        };
+
+    public:
+        StreamCopier(size_t chunksize = 1024 * 1024) :
+            p_chunksize(c_util::umax(chunksize, size_t(4096))),
+            p_method(CopyMethod::None)
+        {}
+
+        // method which was used by last Copy() call
+        CopyMethod method() const { return p_method; }
+
+        // copies up to size bytes, returns amount copied
+        size_t Copy(streamT<size_t> &source, streamT<size_t> &destination, size_t size = COPY_ALL)
+        {
+            p_method = CopyMethod::None;
+
+            if (size == 0 || !readable(source.mode()) || !writable(destination.mode())) {
+                return 0;
+            }
+
+            size_t total;
+            if (CopyMemory(source, destination, size, total)) {
+                p_method = CopyMethod::Memory;
+                return total;
+            }
+
+#if defined(__linux__)
+            auto from = Describe(source);
+            auto to = Describe(destination);
+
+            if (from.file) {
+                size = c_util::umin(size, from.file->size() - from.file->position());
+            }
+
+            if (from.file && to.file && CopyKernel(CopyMethod::CopyFileRange, from, to, size, total)) {
+                p_method = CopyMethod::CopyFileRange;
+                return total;
+            }
+
+            if (from.file && to.handle >= 0 && !to.file && CopyKernel(CopyMethod::SendFile, from, to, size, total)) {
+                p_method = CopyMethod::SendFile;
+                return total;
+            }
+
+            if ((from.pipe || to.pipe) && from.handle >= 0 && to.handle >= 0 &&
+                CopyKernel(CopyMethod::Splice, from, to, size, total)) {
+                p_method = CopyMethod::Splice;
+                return total;
+            }
+#endif
+
+            p_method = CopyMethod::Buffered;
+            return CopyBuffered(source, destination, size);
+        }
+
+    private:
+        static bool readable(StreamMode mode)
+        {
+            return mode != StreamMode::Closed && mode != StreamMode::StreamWrite && mode != StreamMode::SequentialWrite;
+        }
+
+        static bool writable(StreamMode mode)
+        {
+            return mode == StreamMode::StreamWrite || mode == StreamMode::SequentialWrite ||
+                   mode == StreamMode::StreamReadWrite || mode == StreamMode::ReadWrite;
+        }
+
+        static bool CopyMemory(streamT<size_t> &source, streamT<size_t> &destination, size_t size, size_t &total)
+        {
+            Span<unsigned char> data;
+
+            if (auto memory = dynamic_cast<MemoryStream*>(&source)) {
+                data = memory->remaining();
+            } else if (auto mapped = dynamic_cast<MappedFileStream*>(&source)) {
+                data = mapped->remaining();
+            } else {
+                return false;
+            }
+
+            total = destination.write(data.data(), c_util::umin(size, data.size()));
+            source.seek(total, SeekOrigin::Current);
+
+            return true;
+        }
+
+#if defined(__linux__)
+        // descriptor backed stream
+        struct Endpoint
+        {
+            int         handle = -1;
+            FileStream *file = nullptr; // positioned file
+            bool        pipe = false;   // pipe or fifo, could be spliced
+        };
+
+        static Endpoint Describe(streamT<size_t> &stream)
+        {
+            Endpoint result;
+
+            if (auto file = dynamic_cast<FileStream*>(&stream)) {
+                result.handle = file->handle();
+                result.file = file;
+            } else if (auto pipe = dynamic_cast<PipeStream*>(&stream)) {
+                // non blocking streams report wouldblock state which kernel
+                // copy can't maintain
+                if (!pipe->nonblocking()) {
+                    struct stat st;
+                    result.handle = pipe->handle();
+                    result.pipe = fstat(result.handle, &st) == 0 && S_ISFIFO(st.st_mode);
+                }
+            }
+
+            return result;
+        }
+
+        // returns false if method isn't supported for given endpoints,
+        // nothing is copied in that case
+        static bool CopyKernel(CopyMethod method, const Endpoint &from, const Endpoint &to, size_t size, size_t &total)
+        {
+            // max amount kernel transfers with single call anyway
+            enum : size_t { MAX_CALL = 0x7FFFF000 };
+
+            total = 0;
+
+            while (total < size) {
+                auto chunk = c_util::umin(size - total, size_t(MAX_CALL));
+
+                loff_t inpos = from.file ? loff_t(from.file->position()) : 0;
+                loff_t outpos = to.file ? loff_t(to.file->position()) : 0;
+
+                ssize_t amount;
+                switch (method) {
+                    case CopyMethod::CopyFileRange:
+                        amount = copy_file_range(from.handle, &inpos, to.handle, &outpos, chunk, 0);
+                        break;
+
+                    case CopyMethod::SendFile: {
+                        auto offset = off_t(inpos);
+                        amount = sendfile(to.handle, from.handle, &offset, chunk);
+                        break;
+                    }
+
+                    default:
+                        amount = splice(
+                            from.handle, from.file ? &inpos : nullptr,
+                            to.handle, to.file ? &outpos : nullptr,
+                            chunk, SPLICE_F_MOVE
+                        );
+                        break;
+                }
+
+                if (amount < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    // not supported for these descriptors, try other way
+                    if (total == 0 && (
+                        errno == EXDEV || errno == EINVAL || errno == ENOSYS ||
+                        errno == EOPNOTSUPP || errno == EBADF)) {
+                        return false;
+                    }
+                    break;
+                }
+
+                if (amount == 0) {
+                    break;
+                }
+
+                if (from.file) {
+                    from.file->Advance(size_t(amount));
+                }
+                if (to.file) {
+                    to.file->Advance(size_t(amount));
+                }
+
+                total += size_t(amount);
+            }
+
+            return true;
+        }
+#endif
+
+        size_t CopyBuffered(streamT<size_t> &source, streamT<size_t> &destination, size_t size)
+        {
+            // owned buffer isn't leaked if reader thread can't be started
+            std::unique_ptr<unsigned char[]> storage(new unsigned char[p_chunksize * 2]);
+            auto buffer = storage.get();
+            auto total = size_t(0);
+
+            if (size <= p_chunksize) {
+                // single chunk, nothing to overlap, source could return
+                // less than requested before its end (like pipe does)
+                while (total < size) {
+                    auto amount = source.read(buffer + total, size - total);
+                    if (amount == 0) {
+                        break;
+                    }
+                    total += amount;
+                }
+                return destination.write(buffer, total);
+            }
+
+            // chunk slots filled by reader thread and emptied by writer
+            struct Slot
+            {
+                size_t amount = 0;
+                bool   full = false;
+                bool   last = false;
+            };
+
+            Slot slots[2];
+            std::mutex lock;
+            std::condition_variable signal;
+            auto stop = false;
+
+            std::thread reader([&] {
+                auto remaining = size;
+                for (auto index = 0; ; index ^= 1) {
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        signal.wait(guard, [&] { return !slots[index].full || stop; });
+                        if (stop) {
+                            break;
+                        }
+                    }
+
+                    auto requested = c_util::umin(remaining, p_chunksize);
+                    auto amount = source.read(buffer + index * p_chunksize, requested);
+                    remaining -= amount;
+
+                    std::lock_guard<std::mutex> guard(lock);
+                    slots[index].amount = amount;
+                    slots[index].last = amount == 0 || remaining == 0;
+                    slots[index].full = true;
+                    signal.notify_all();
+
+                    if (slots[index].last) {
+                        break;
+                    }
+                }
+            });
+
+            for (auto index = 0; ; index ^= 1) {
+                Slot slot;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    signal.wait(guard, [&] { return slots[index].full; });
+                    slot = slots[index];
+                }
+
+                auto written = destination.write(buffer + index * p_chunksize, slot.amount);
+                total += written;
+
+                std::lock_guard<std::mutex> guard(lock);
+                slots[index].full = false;
+                if (written < slot.amount) {
+                    stop = true;
+                }
+                signal.notify_all();
+
+                if (stop || slot.last) {
+                    break;
+                }
+            }
+
+            reader.join();
+
+            return total;
+        }
+
+    private:
+        size_t     p_chunksize;
+        CopyMethod p_method;
+    };
+
+
+    // copies up to size bytes from source to destination, returns amount copied
+    inline size_t CopyStream(streamT<size_t> &source, streamT<size_t> &destination, size_t size = StreamCopier::COPY_ALL)
+    {
+        return StreamCopier().Copy(source, destination, size);
+    }
+}
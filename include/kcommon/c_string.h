@@ -40,8 +40,20 @@ namespace c_common
     };
 
 
-    // TODO add allocator parametrization
-    template <typename T, typename M, typename N>
+    // default string memory allocator, allocator is a static policy which
+    // provides Allocate()/Free() pair, string gives memory back only to
+    // the allocator it got it from, growing string or builder passes its
+    // current block to Allocate() so allocator could keep new block with it
+    template <typename T>
+    struct StringDefaultAllocator
+    {
+        static T *Allocate(size_t count) { return new T[count]; }
+        static T *Allocate(size_t count, const T *) { return new T[count]; }
+        static void Free(T *data) noexcept { delete[] data; }
+    };
+
+
+    template <typename T, typename M, typename N, typename A>
     class StringStore : public StringViewBase<T, M>
     {
     protected:
@@ -85,14 +97,22 @@ namespace c_common
             EnsureNull();
         }
 
-        void CleanUp() noexcept
+        // memory taken from allocator, nullptr for shared empty string
+        T *block() const noexcept
         {
             if constexpr (N::NULL_LEN != 0) {
                 if (this->p_data == &StringStaticData<typename M::storage_type>::s_null) {
-                    return;
+                    return nullptr;
                 }
             }
-            delete[] this->p_data;
+            return this->p_data;
+        }
+
+        void CleanUp() noexcept
+        {
+            if (auto data = block()) {
+                A::Free(data);
+            }
         }
 
         static constexpr size_t actualsize(size_t size) noexcept
@@ -111,21 +131,21 @@ namespace c_common
     };
 
 #if _DEBUG
-    template <typename T, typename M, typename N>
-    size_t StringStore<T, M, N>::dbg_instances = 0;
+    template <typename T, typename M, typename N, typename A>
+    size_t StringStore<T, M, N, A>::dbg_instances = 0;
 
-    template <typename T, typename M, typename N>
-    size_t StringStore<T, M, N>::dbg_allocated = 0;
+    template <typename T, typename M, typename N, typename A>
+    size_t StringStore<T, M, N, A>::dbg_allocated = 0;
 #endif
 
 
-    template <typename T, typename N>
+    template <typename T, typename N, typename A>
     class MutableStringBase;
 
     template <typename T, typename N>
     class FixedStringBuilderBase;
 
-    template <typename T, typename N>
+    template <typename T, typename N, typename A>
     class DynamicStringBuilderBase;
 
 
@@ -136,12 +156,12 @@ namespace c_common
         using storage_type = T;
     };
 
-    template <typename T, typename N = StringExcludeNull>
-    class StringBase : public StringStore<T, ImmutableStringData<T>, N>
+    template <typename T, typename N = StringExcludeNull, typename A = StringDefaultAllocator<T>>
+    class StringBase : public StringStore<T, ImmutableStringData<T>, N, A>
     {
-        friend class MutableStringBase<T, N>;
+        friend class MutableStringBase<T, N, A>;
         friend class FixedStringBuilderBase<T, N>;
-        friend class DynamicStringBuilderBase<T, N>;
+        friend class DynamicStringBuilderBase<T, N, A>;
 
     public:
         StringBase() noexcept
@@ -162,7 +182,7 @@ namespace c_common
             this->CopyFromSource(begin);
         }
 
-        StringBase(const StringBase<T, N> &other)
+        StringBase(const StringBase<T, N, A> &other)
         {
             Allocate(other.size());
             this->CopyFromSource(other.data());
@@ -175,7 +195,7 @@ namespace c_common
             this->CopyFromSource(other.data());
         }
 
-        StringBase(StringBase<T, N> &&other) noexcept
+        StringBase(StringBase<T, N, A> &&other) noexcept
         {
             this->p_data = other.p_data;
             this->p_size = other.p_size;
@@ -184,7 +204,7 @@ namespace c_common
             other.p_size = 0;
         }
 
-        StringBase(MutableStringBase<T, N> &&other) noexcept
+        StringBase(MutableStringBase<T, N, A> &&other) noexcept
         {
             this->p_data = other.p_data;
             this->p_size = other.p_size;
@@ -195,23 +215,23 @@ namespace c_common
         }
 
 
-        StringBase<T, N> &operator=(const StringBase<T, N> &other)
+        StringBase<T, N, A> &operator=(const StringBase<T, N, A> &other)
         {
             ReallocateDiscard(other.size());
             this->CopyFromSource(other.data());
             return *this;
         }
 
-        template <typename NN>
-        StringBase<T, N> &operator=(const StringBase<T, NN> &other)
+        template <typename NN, typename AA>
+        StringBase<T, N, A> &operator=(const StringBase<T, NN, AA> &other)
         {
             ReallocateDiscard(other.size());
             this->CopyFromSource(other.data());
             return *this;
         }
 
-        template <typename NN>
-        StringBase<T, N> &operator=(const MutableStringBase<T, NN> &other)
+        template <typename NN, typename AA>
+        StringBase<T, N, A> &operator=(const MutableStringBase<T, NN, AA> &other)
         {
             ReallocateDiscard(other.size());
             this->CopyFromSource(other.size());
@@ -219,14 +239,14 @@ namespace c_common
         }
 
         template <size_t length>
-        StringBase<T, N> &operator=(const T(&text)[length])
+        StringBase<T, N, A> &operator=(const T(&text)[length])
         {
             ReallocateDiscard(length - 1);
             this->CopyFromSource(text);
             return *this;
         }
 
-        StringBase<T, N> &operator=(T ch)
+        StringBase<T, N, A> &operator=(T ch)
         {
             ReallocateDiscard(1);
             this->CopyFromSource(&ch);
@@ -235,14 +255,14 @@ namespace c_common
 
 
         template <typename M>
-        StringBase<T, N> &operator=(const StringViewBase<T, M> &other)
+        StringBase<T, N, A> &operator=(const StringViewBase<T, M> &other)
         {
             ReallocateDiscard(other.size());
             this->CopyFromSource(other.data());
             return *this;
         }
 
-        StringBase<T, N> &operator=(StringBase<T, N> &&other)
+        StringBase<T, N, A> &operator=(StringBase<T, N, A> &&other)
         {
             this->CleanUp();
 
@@ -255,7 +275,7 @@ namespace c_common
             return *this;
         }
 
-        StringBase<T, N> &operator=(MutableStringBase<T, N> &&other)
+        StringBase<T, N, A> &operator=(MutableStringBase<T, N, A> &&other)
         {
             this->CleanUp();
 
@@ -269,6 +289,16 @@ namespace c_common
             return *this;
         }
 
+        // takes ownership of buffer allocated by A, buffer must have room
+        // for size characters and null character if string includes it,
+        // null character is set by string
+        static StringBase<T, N, A> Adopt(T *data, size_t size) noexcept
+        {
+            auto result = StringBase<T, N, A>(data, size);
+            result.EnsureNull();
+            return result;
+        }
+
     protected:
         void Allocate(size_t size)
         {
@@ -280,7 +310,7 @@ namespace c_common
             }
 
             auto alloccount = calcalloc(this->actualsize(size));
-            this->p_data = new T[alloccount];
+            this->p_data = A::Allocate(alloccount);
             this->p_size = size;
         }
 
@@ -327,11 +357,11 @@ namespace c_common
     using String32NT = StringBase<uint32_t, StringIncludeNull>;
 
 
-    template <typename T, typename N = StringExcludeNull>
-    class MutableStringBase : public StringStore<T, MutableSpanData<T>, N>
+    template <typename T, typename N = StringExcludeNull, typename A = StringDefaultAllocator<T>>
+    class MutableStringBase : public StringStore<T, MutableSpanData<T>, N, A>
     {
-        friend class StringBase<T, N>;
-        friend class DynamicStringBuilderBase<T, N>;
+        friend class StringBase<T, N, A>;
+        friend class DynamicStringBuilderBase<T, N, A>;
 
     public:
         constexpr MutableStringBase() noexcept :
@@ -355,7 +385,7 @@ namespace c_common
             this->CopyFromSource(begin);
         }
 
-        MutableStringBase(const MutableStringBase<T, N> &other) :
+        MutableStringBase(const MutableStringBase<T, N, A> &other) :
             p_capacity(calccapacity(this->actualsize(other.size())))
         {
             Allocate(other.size());
@@ -370,7 +400,7 @@ namespace c_common
             this->CopyFromSource(other.data());
         }
 
-        MutableStringBase(StringBase<T, N> &&other) :
+        MutableStringBase(StringBase<T, N, A> &&other) :
             // NOTE - can't align capacity as String does not have aligned storage
             p_capacity(this->actualsize(other.p_size))
         {
@@ -381,7 +411,7 @@ namespace c_common
             other.p_size = 0;
         }
 
-        MutableStringBase(MutableStringBase<T, N> &&other) :
+        MutableStringBase(MutableStringBase<T, N, A> &&other) :
             p_capacity(other.p_capacity)
         {
             this->p_data = other.p_data;
@@ -393,7 +423,7 @@ namespace c_common
         }
 
         template <size_t length>
-        MutableStringBase<T, N> &operator=(const T(&text)[length])
+        MutableStringBase<T, N, A> &operator=(const T(&text)[length])
         {
             Reserve(this->actualsize(length - 1), false);
             this->p_size = length - 1;
@@ -402,7 +432,7 @@ namespace c_common
         }
 
         template <typename M>
-        MutableStringBase<T, N> &operator=(const StringViewBase<T, M> &other)
+        MutableStringBase<T, N, A> &operator=(const StringViewBase<T, M> &other)
         {
             Reserve(other.size(), false);
             this->p_size = other.size();
@@ -410,7 +440,7 @@ namespace c_common
             return *this;
         }
 
-        MutableStringBase<T, N> &operator=(MutableStringBase<T, N> &&other)
+        MutableStringBase<T, N, A> &operator=(MutableStringBase<T, N, A> &&other)
         {
             this->CleanUp();
 
@@ -425,7 +455,7 @@ namespace c_common
             return *this;
         }
 
-        MutableStringBase<T, N> &operator=(StringBase<T, N> &&other)
+        MutableStringBase<T, N, A> &operator=(StringBase<T, N, A> &&other)
         {
             this->CleanUp();
 
@@ -439,6 +469,19 @@ namespace c_common
             return *this;
         }
 
+        // takes ownership of buffer of capacity characters allocated by A,
+        // buffer must have room for null character if string includes it,
+        // null character is set by string
+        static MutableStringBase<T, N, A> Adopt(T *data, size_t size, size_t capacity) noexcept
+        {
+            MutableStringBase<T, N, A> result;
+            result.p_data = data;
+            result.p_size = size;
+            result.p_capacity = capacity;
+            result.EnsureNull();
+            return result;
+        }
+
 
         const T *data() const { return this->p_data; }
         T *data() { return this->p_data; }
@@ -446,7 +489,7 @@ namespace c_common
         size_t capacity() const { return p_capacity; }
 
 
-        MutableStringBase<T, N> &operator+=(T ch)
+        MutableStringBase<T, N, A> &operator+=(T ch)
         {
             reserve(this->actualsize(this->p_size + 1));
             this->p_data[this->p_size++] = ch;
@@ -455,7 +498,7 @@ namespace c_common
         }
 
         template <typename M>
-        MutableStringBase<T, N> &operator+=(const StringViewBase<T, M> &str)
+        MutableStringBase<T, N, A> &operator+=(const StringViewBase<T, M> &str)
         {
             reserve(this->actualsize(this->p_size + str.size()));
 
@@ -471,7 +514,7 @@ namespace c_common
         }
 
         template <size_t length>
-        MutableStringBase<T, N> &operator+=(const T(&text)[length])
+        MutableStringBase<T, N, A> &operator+=(const T(&text)[length])
         {
             reserve(this->actualsize(this->p_size + length - 1));
 
@@ -629,7 +672,7 @@ namespace c_common
                 return;
             }
 
-            this->p_data = new T[p_capacity];
+            this->p_data = A::Allocate(p_capacity);
             this->p_size = size;
 
             if (size == 0) {
@@ -641,7 +684,7 @@ namespace c_common
         {
             if (capacity > p_capacity) {
                 auto newcapacity = calccapacity(capacity);
-                auto newdata = new T[newcapacity];
+                auto newdata = A::Allocate(newcapacity, this->block());
 
                 if (preservesource) {
                     auto minsize = this->p_size;
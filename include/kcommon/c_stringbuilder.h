@@ -11,20 +11,206 @@
 #pragma once
 
 #include "c_string.h"
+#include "c_stream.h"
+#include <type_traits>
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+#define KCOMMON_FORMAT_STRINGS 1
+#include <tuple>
+#endif
 
 
 namespace c_common
 {
+#if KCOMMON_FORMAT_STRINGS
+    /*
+     -------------------------------------------------------------------------------
+     compile time format strings
+     -------------------------------------------------------------------------------
+         format string is passed as template argument to Format() and parsed
+         at compile time into literal segments and argument slots:
+
+            {}       - next argument
+            {:W}     - next argument with width W (same as width() call)
+            {:W.P}   - next argument with width W and precision P
+            {:.P}    - next argument with precision P (floating point only)
+            {{ }}    - literal braces
+
+         malformed format string, argument count mismatch, unsupported
+         argument type or precision for non floating point argument are
+         compile time errors
+    */
+
+    template <typename C, size_t L>
+    struct FormatString
+    {
+        C text[L] = {};
+
+        constexpr FormatString(const C(&source)[L])
+        {
+            for (auto n = size_t(0); n < L; ++n) {
+                text[n] = source[n];
+            }
+        }
+    };
+
+    struct FormatItem
+    {
+        size_t   start = 0;         // literal start in format string
+        size_t   length = 0;        // literal length, 0 for argument
+        int      argument = -1;     // argument index, -1 for literal
+        unsigned width = -1;
+        unsigned precision = -1;
+    };
+
+    template <size_t L>
+    struct FormatLayout
+    {
+        FormatItem items[L];
+        size_t     count = 0;
+        size_t     arguments = 0;
+        size_t     literals = 0;    // total length of literal text
+        size_t     widths = 0;      // total of argument widths
+        bool       valid = true;
+    };
+
+    template <typename C, size_t L>
+    constexpr FormatLayout<L> FormatParse(const FormatString<C, L> &format)
+    {
+        FormatLayout<L> result;
+
+        auto text = format.text;
+        auto length = L - 1;
+        auto literal = size_t(0);
+
+        auto addliteral = [&](size_t end) {
+            if (end > literal) {
+                auto &item = result.items[result.count++];
+                item.start = literal;
+                item.length = end - literal;
+                result.literals += end - literal;
+            }
+        };
+
+        auto number = [&](size_t &pos, unsigned &value) {
+            auto start = pos;
+            value = 0;
+            while (pos < length && text[pos] >= '0' && text[pos] <= '9') {
+                value = value * 10 + unsigned(text[pos++] - '0');
+            }
+            return pos > start;
+        };
+
+        auto pos = size_t(0);
+        while (pos < length) {
+            auto c = text[pos];
+
+            if (c == '}' || (c == '{' && pos + 1 < length && text[pos + 1] == '{')) {
+                if (pos + 1 >= length || text[pos + 1] != c) {
+                    result.valid = false;
+                    return result;
+                }
+
+                // keep single brace as literal
+                addliteral(pos + 1);
+                pos += 2;
+                literal = pos;
+                continue;
+            }
+
+            if (c != '{') {
+                ++pos;
+                continue;
+            }
+
+            addliteral(pos++);
+
+            FormatItem item;
+            item.argument = int(result.arguments++);
+
+            if (pos < length && text[pos] == ':') {
+                ++pos;
+                if (number(pos, item.width)) {
+                    result.widths += item.width;
+                } else {
+                    item.width = -1;
+                }
+                if (pos < length && text[pos] == '.') {
+                    ++pos;
+                    if (!number(pos, item.precision)) {
+                        result.valid = false;
+                        return result;
+                    }
+                }
+            }
+
+            if (pos >= length || text[pos] != '}') {
+                result.valid = false;
+                return result;
+            }
+
+            result.items[result.count++] = item;
+            literal = ++pos;
+        }
+
+        addliteral(length);
+
+        return result;
+    }
+
+    template <auto F>
+    inline constexpr auto FormatLayoutOf = FormatParse(F);
+
+    // argument types accepted by Format()
+    template <typename T, typename V>
+    struct FormatArgument
+    {
+        using type = std::remove_cv_t<std::remove_reference_t<V>>;
+
+        static constexpr bool character = std::is_same_v<type, T>;
+        static constexpr bool integer = std::is_integral_v<type> && !character && !std::is_same_v<type, bool>;
+        static constexpr bool floating = std::is_floating_point_v<type>;
+        static constexpr bool cstring =
+            std::is_same_v<std::decay_t<type>, const T*> || std::is_same_v<std::decay_t<type>, T*>;
+        static constexpr bool string = std::is_convertible_v<const type&, StringViewBase<T>> && !cstring;
+
+        static constexpr bool valid = character || integer || floating || cstring || string;
+    };
+#endif
+
+
+    // reallocator is a base of StringBuilderBase, its Resize() is called
+    // before every write of count elements, it could grow the buffer or
+    // make room some other way (by flushing buffer contents and resetting
+    // size for example), reallocator could keep its own state
     template <typename T>
     class StringBuilderStaticReallocator
     {
     public:
-        static void Resize(T* &buffer, size_t &capacity, size_t size) {}
+        static void Resize(T* &buffer, size_t &capacity, size_t &size, size_t count) {}
+    };
+
+    // reallocator of builder over memory which is known to fit everything
+    // written to it (see Compose()), such builder skips capacity checks
+    template <typename T>
+    class StringBuilderUncheckedReallocator
+    {
+    public:
+        static void Resize(T* &, size_t &, size_t &, size_t) {}
     };
 
+    template <typename T>
+    class StringMeasureBase;
+
+    template <typename T, typename N, typename R>
+    class ExternalStringBuilderBase;
+
     template <typename T, typename N = StringExcludeNull, typename R = StringBuilderStaticReallocator<T>>
-    class StringBuilderBase
+    class StringBuilderBase : protected R
     {
+        template <typename TT, typename NN, typename RR>
+        friend class StringBuilderBase;
+
     protected:
         constexpr StringBuilderBase(T *buffer, size_t capacity = 0) noexcept :
             p_buffer(buffer),
@@ -56,16 +242,20 @@ namespace c_common
                 reqsize = p_width;
             }
 
-            R::Resize(p_buffer, p_capacity, p_size + reqsize);
+            if constexpr (!std::is_same<R, StringBuilderUncheckedReallocator<T>>::value) {
+                this->Resize(p_buffer, p_capacity, p_size, reqsize);
 
-            if (p_size >= (p_capacity - N::NULL_LEN)) {
-                return;
-            }
-            if ((p_size + reqsize + N::NULL_LEN) > p_capacity) {
-                reqsize = p_capacity - p_size - N::NULL_LEN;
-            }
-            if (reqsize < size) {
-                size = reqsize;
+                if (p_size >= (p_capacity - N::NULL_LEN)) {
+                    p_precision = -1;
+                    p_width = -1;
+                    return;
+                }
+                if ((p_size + reqsize + N::NULL_LEN) > p_capacity) {
+                    reqsize = p_capacity - p_size - N::NULL_LEN;
+                }
+                if (reqsize < size) {
+                    size = reqsize;
+                }
             }
 
             if (size < reqsize) {
@@ -113,9 +303,16 @@ namespace c_common
 
         void Write(double value)
         {
+            // width applies to whole number (in Write() below), not to its
+            // integer and fraction parts
+            auto width = p_width;
+            p_width = -1;
+
             T buffer[512];
             auto size = size_t(0);
             ToString(buffer, 512, size, value);
+
+            p_width = width;
             Write(buffer, size);
         }
 
@@ -146,7 +343,150 @@ namespace c_common
             p_width = w;
         }
 
+        // makes room for count more elements at once
+        void Reserve(size_t count)
+        {
+            this->Resize(p_buffer, p_capacity, p_size, count);
+        }
+
+        // measure then write, writes arguments like << chain does:
+        //     sb.Compose(name, ": ", value);
+        // arguments are measured with StringMeasureBase to get exact output
+        // size, then room is reserved once and they are written directly
+        // into reserved memory without capacity checks, pending width and
+        // precision apply to first argument as with << chain
+        //
+        // if builder can't make enough room (fixed size builder) arguments
+        // are written with usual checked writes and could be truncated
+        template <typename... A>
+        void Compose(const A &...args)
+        {
+            StringMeasureBase<T> measure;
+            measure.CopyFormat(*this);
+            (measure << ... << args);
+
+            auto count = measure.measured();
+            Reserve(count);
+
+            if ((p_size + count + N::NULL_LEN) > p_capacity) {
+                (*this << ... << args);
+                return;
+            }
+
+            ExternalStringBuilderBase<T, N, StringBuilderUncheckedReallocator<T>> direct(p_buffer + p_size, count + N::NULL_LEN);
+            direct.CopyFormat(*this);
+            (direct << ... << args);
+
+            p_size += direct.size();
+
+            if constexpr (sizeof...(A) > 0) {
+                p_precision = -1;
+                p_width = -1;
+            }
+        }
+
+#if KCOMMON_FORMAT_STRINGS
+        // formats arguments with compile time format string, see FormatParse()
+        //     sb.Format<"{}: {:8.3}">(name, value);
+        template <FormatString F, typename... A>
+        void Format(const A &...args)
+        {
+            constexpr auto &layout = FormatLayoutOf<F>;
+
+            static_assert(std::is_same_v<std::remove_cv_t<std::remove_extent_t<decltype(F.text)>>, T>, "format string character type doesn't match builder");
+            static_assert(layout.valid, "malformed format string");
+            static_assert(layout.arguments == sizeof...(A), "format argument count doesn't match format string");
+            static_assert((FormatArgument<T, A>::valid && ...), "unsupported format argument type");
+            static_assert(FormatPrecisionValid<F, A...>(), "precision is allowed only for floating point arguments");
+
+            // make room for whole output at once
+            auto estimate = layout.literals + layout.widths + (size_t(0) + ... + FormatEstimate(args));
+            this->Resize(p_buffer, p_capacity, p_size, estimate);
+
+            FormatItems<F, 0>(std::forward_as_tuple(args...));
+        }
+#endif
+
     protected:
+#if KCOMMON_FORMAT_STRINGS
+        template <FormatString F, typename... A>
+        static constexpr bool FormatPrecisionValid()
+        {
+            constexpr auto &layout = FormatLayoutOf<F>;
+            constexpr bool floating[] = { FormatArgument<T, A>::floating..., false };
+
+            for (auto n = size_t(0); n < layout.count; ++n) {
+                auto &item = layout.items[n];
+                if (item.argument >= 0 && item.precision != unsigned(-1) && !floating[item.argument]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        template <typename V>
+        static size_t FormatEstimate(const V &value)
+        {
+            using arg = FormatArgument<T, V>;
+            if constexpr (arg::character) {
+                return 1;
+            } else if constexpr (arg::integer) {
+                return 24;
+            } else if constexpr (arg::floating) {
+                return 48;
+            } else if constexpr (arg::string) {
+                return StringViewBase<T>(value).size();
+            } else {
+                return 0;
+            }
+        }
+
+        template <FormatString F, size_t index, typename P>
+        void FormatItems(const P &args)
+        {
+            constexpr auto &layout = FormatLayoutOf<F>;
+
+            if constexpr (index < layout.count) {
+                constexpr auto item = layout.items[index];
+
+                if constexpr (item.argument < 0) {
+                    Write(F.text + item.start, item.length);
+                } else {
+                    p_width = item.width;
+                    p_precision = item.precision;
+                    FormatValue(std::get<item.argument>(args));
+                }
+
+                FormatItems<F, index + 1>(args);
+            }
+        }
+
+        template <typename V>
+        void FormatValue(const V &value)
+        {
+            using arg = FormatArgument<T, V>;
+            if constexpr (arg::character) {
+                Write(&value, 1);
+            } else if constexpr (arg::integer && std::is_signed_v<V>) {
+                Write((long long int)value);
+            } else if constexpr (arg::integer) {
+                Write((long long unsigned)value);
+            } else if constexpr (arg::floating) {
+                Write(double(value));
+            } else if constexpr (arg::cstring) {
+                const T *text = value;
+                auto length = size_t(0);
+                while (text[length]) {
+                    ++length;
+                }
+                Write(text, length);
+            } else {
+                Write(StringViewBase<T>(value));
+            }
+        }
+#endif
+
         void ToString(T *buffer, size_t capacity, size_t &size, long long unsigned value)
         {
             auto n = capacity;
@@ -257,6 +597,16 @@ namespace c_common
             size += digits;
         }
 
+        // takes formatting state of other builder
+        template <typename NN, typename RR>
+        void CopyFormat(const StringBuilderBase<T, NN, RR> &source) noexcept
+        {
+            p_width = source.p_width;
+            p_precision = source.p_precision;
+            p_textfill = source.p_textfill;
+            p_numberfill = source.p_numberfill;
+        }
+
     protected:
         T        *p_buffer;
         size_t    p_size;
@@ -338,15 +688,15 @@ namespace c_common
         return sb;
     }
 
-    template <typename T, typename N, typename R, typename NN>
-    StringBuilderBase<T, N, R> &operator<<(StringBuilderBase<T, N, R> &sb, const StringBase<T, NN> &value)
+    template <typename T, typename N, typename R, typename NN, typename A>
+    StringBuilderBase<T, N, R> &operator<<(StringBuilderBase<T, N, R> &sb, const StringBase<T, NN, A> &value)
     {
         sb.Write(value);
         return sb;
     }
 
-    template <typename T, typename N, typename R, typename NN>
-    StringBuilderBase<T, N, R> &operator<<(StringBuilderBase<T, N, R> &sb, const MutableStringBase<T, NN> &value)
+    template <typename T, typename N, typename R, typename NN, typename A>
+    StringBuilderBase<T, N, R> &operator<<(StringBuilderBase<T, N, R> &sb, const MutableStringBase<T, NN, A> &value)
     {
         sb.Write(value);
         return sb;
@@ -382,6 +732,61 @@ namespace c_common
     using StaticStringBuilder32 = StaticStringBuilderBase<char32_t, capacity>;
 
 
+    // builder over memory provided by caller, it never reallocates
+    template <typename T, typename N = StringExcludeNull, typename R = StringBuilderStaticReallocator<T>>
+    class ExternalStringBuilderBase : public StringBuilderBase<T, N, R>
+    {
+    public:
+        ExternalStringBuilderBase(T *buffer, size_t capacity) noexcept :
+            StringBuilderBase<T, N, R>(buffer, capacity)
+        {}
+    };
+
+
+    /*
+     -------------------------------------------------------------------------------
+     StringMeasureBase<T>
+     -------------------------------------------------------------------------------
+         builder which doesn't store anything, it only counts size of
+         everything written to it, including width padding, so it gives
+         exact size of the same writes to real builder (unless real builder
+         truncates them)
+    */
+
+    template <typename T>
+    class StringBuilderMeasurer
+    {
+    public:
+        void Resize(T* &, size_t &, size_t &, size_t count)
+        {
+            p_measured += count;
+        }
+
+    protected:
+        size_t p_measured = 0;
+    };
+
+    template <typename T>
+    class StringMeasureBase : public StringBuilderBase<T, StringExcludeNull, StringBuilderMeasurer<T>>
+    {
+    public:
+        StringMeasureBase() noexcept :
+            StringBuilderBase<T, StringExcludeNull, StringBuilderMeasurer<T>>(nullptr, 0)
+        {}
+
+        size_t measured() const { return this->p_measured; }
+
+        void Reset()
+        {
+            this->p_measured = 0;
+        }
+    };
+
+    using StringMeasure = StringMeasureBase<char>;
+    using StringMeasureW = StringMeasureBase<wchar_t>;
+    using StringMeasure32 = StringMeasureBase<char32_t>;
+
+
     template <typename T, typename N = StringExcludeNull>
     class FixedStringBuilderBase : public StringBuilderBase<T, N>
     {
@@ -428,19 +833,31 @@ namespace c_common
     using FixedStringBuilder32NT = FixedStringBuilderBase<char32_t, StringIncludeNull>;
 
 
-    template <typename T>
+    template <typename T, typename A = StringDefaultAllocator<T>>
     class StringBuilderDefaultReallocator
     {
     public:
-        static void Resize(T* &buffer, size_t &capacity, size_t size)
+        static void Resize(T* &buffer, size_t &capacity, size_t &size, size_t count)
         {
-            if (size > capacity) {
-                auto newcapacity = capacity + 1024;
-                auto newbuffer = new T[newcapacity];
+            Grow(buffer, capacity, size + count);
+        }
+
+    protected:
+        static void Grow(T* &buffer, size_t &capacity, size_t size)
+        {
+            // NOTE: >= keeps room for null terminator
+            if (size >= capacity) {
+                // grow geometrically, but always enough to fit requested size,
+                // so single large write is never truncated
+                auto newcapacity = capacity + capacity / 2;
+                if (newcapacity <= size) {
+                    newcapacity = ((size + 1024) / 1024) * 1024;
+                }
+                auto newbuffer = A::Allocate(newcapacity, buffer);
 
                 memcpy(newbuffer, buffer, capacity * sizeof(T));
 
-                delete[] buffer;
+                A::Free(buffer);
 
                 buffer = newbuffer;
                 capacity = newcapacity;
@@ -449,22 +866,22 @@ namespace c_common
     };
 
 
-    template <typename T, typename N = StringExcludeNull>
-    class DynamicStringBuilderBase : public StringBuilderBase<T, N, StringBuilderDefaultReallocator<T>>
+    template <typename T, typename N = StringExcludeNull, typename A = StringDefaultAllocator<T>>
+    class DynamicStringBuilderBase : public StringBuilderBase<T, N, StringBuilderDefaultReallocator<T, A>>
     {
     public:
         DynamicStringBuilderBase(size_t initialcapacity = 1024) :
-            StringBuilderBase<T, N, StringBuilderDefaultReallocator<T>>(new T[initialcapacity], initialcapacity)
+            StringBuilderBase<T, N, StringBuilderDefaultReallocator<T, A>>(A::Allocate(initialcapacity), initialcapacity)
         {}
 
         ~DynamicStringBuilderBase()
         {
-            delete[] this->p_buffer;
+            A::Free(this->p_buffer);
         }
 
-        StringBase<T, N> MoveToString()
+        StringBase<T, N, A> MoveToString()
         {
-            StringBase<T, N> result;
+            StringBase<T, N, A> result;
 
             result.p_data = this->p_buffer;
             result.p_size = this->p_size;
@@ -476,9 +893,9 @@ namespace c_common
             return result;
         }
 
-        MutableStringBase<T, N> MoveToMutableString()
+        MutableStringBase<T, N, A> MoveToMutableString()
         {
-            MutableStringBase<T, N> result;
+            MutableStringBase<T, N, A> result;
 
             result.p_data = this->p_buffer;
             result.p_size = this->p_size;
@@ -500,6 +917,129 @@ namespace c_common
     using StringBuilder32NT = DynamicStringBuilderBase<char32_t, StringIncludeNull>;
 
 
+    /*
+     -------------------------------------------------------------------------------
+     StreamStringBuilderBase<T, N>
+     -------------------------------------------------------------------------------
+         string builder which writes its contents to a stream whenever buffer
+         gets full, so any amount of text is produced with constant memory
+
+         builder has full StringBuilderBase interface and formatting state,
+         data()/text() give only text which isn't flushed yet, Revert() can't
+         revert flushed text
+
+         buffer grows only if single write doesn't fit it
+
+         remaining text is flushed on destruction, but write errors are lost
+         there, call Flush() explicitly to check that all text got written,
+         text which stream didn't take stays in buffer (data() gives it) and
+         next flush tries to write it again, while it's there buffer doesn't
+         grow and text which doesn't fit is dropped (see failed())
+    */
+
+    template <typename T>
+    class StringBuilderStreamFlusher : public StringBuilderDefaultReallocator<T>
+    {
+    public:
+        void Resize(T* &buffer, size_t &capacity, size_t &size, size_t count)
+        {
+            // NOTE: >= keeps room for null terminator
+            if ((size + count) >= capacity) {
+                // buffer doesn't grow after failed flush, so failing stream
+                // doesn't make builder take more and more memory
+                if (FlushBuffer(buffer, size)) {
+                    this->Grow(buffer, capacity, count);
+                }
+            }
+        }
+
+    protected:
+        // writes until stream stops taking data, unwritten tail is kept at
+        // buffer start so it's written by next flush, bytes of partially
+        // written first element aren't written again
+        bool FlushBuffer(T *buffer, size_t &size)
+        {
+            if (size == 0) {
+                return true;
+            }
+
+            auto bytes = size * sizeof(T);
+            auto data = reinterpret_cast<const char*>(buffer);
+            auto offset = p_partial;
+
+            while (p_stream && offset < bytes) {
+                auto written = p_stream->write(data + offset, bytes - offset);
+                if (written == 0) {
+                    break;
+                }
+                offset += c_util::umin(written, bytes - offset);
+            }
+
+            auto done = offset / sizeof(T);
+            p_partial = offset % sizeof(T);
+            p_flushed += done;
+            size -= done;
+
+            if (size) {
+                memmove(buffer, buffer + done, size * sizeof(T));
+                p_failed = true;
+                return false;
+            }
+
+            return true;
+        }
+
+    protected:
+        streamT<size_t> *p_stream = nullptr;
+        size_t           p_flushed = 0; // amount of elements flushed to stream
+        size_t           p_partial = 0; // written bytes of first buffered element
+        bool             p_failed = false;
+    };
+
+    template <typename T, typename N = StringExcludeNull>
+    class StreamStringBuilderBase : public StringBuilderBase<T, N, StringBuilderStreamFlusher<T>>
+    {
+    public:
+        StreamStringBuilderBase(streamT<size_t> &stream, size_t buffersize = 64 * 1024) :
+            StringBuilderBase<T, N, StringBuilderStreamFlusher<T>>(new T[buffersize], buffersize)
+        {
+            this->p_stream = &stream;
+        }
+
+        StreamStringBuilderBase(const StreamStringBuilderBase<T, N> &) = delete;
+        StreamStringBuilderBase<T, N> &operator=(const StreamStringBuilderBase<T, N> &) = delete;
+
+        ~StreamStringBuilderBase()
+        {
+            Flush();
+            delete[] this->p_buffer;
+        }
+
+        streamT<size_t> &stream() const { return *this->p_stream; }
+
+        // total amount of elements written so far (flushed and buffered)
+        size_t total() const { return this->p_flushed + this->p_size; }
+
+        // some flush failed to write all data
+        bool failed() const { return this->p_failed; }
+
+        bool Flush()
+        {
+            auto result = this->FlushBuffer(this->p_buffer, this->p_size);
+
+            if constexpr (N::NULL_LEN) {
+                this->p_buffer[this->p_size] = 0;
+            }
+
+            return result;
+        }
+    };
+
+    using StreamStringBuilder = StreamStringBuilderBase<char>;
+    using StreamStringBuilderW = StreamStringBuilderBase<wchar_t>;
+    using StreamStringBuilder32 = StreamStringBuilderBase<char32_t>;
+
+
     template <typename T, typename N = StringExcludeNull>
     class BakedStringBuilderBase : public StringBuilderBase<T, N, StringBuilderDefaultReallocator<T>>
     {
@@ -0,0 +1,161 @@
+/*
+        thread local string builder pool
+
+    (c) livingcreative, 2025
+
+    https://github.com/livingcreative/kcommon
+
+    feel free to use and modify
+*/
+
+#pragma once
+
+#include "c_stringbuilder.h"
+
+
+namespace c_common
+{
+    /*
+     -------------------------------------------------------------------------------
+     StringBuilderPoolBase<T, N>
+     -------------------------------------------------------------------------------
+         per thread cache of dynamic string builders
+
+         Acquire() gives Lease which holds cleared builder, when lease is
+         destroyed builder returns to the pool with its buffer, so after
+         warm up formatting doesn't allocate memory
+
+            auto sb = StringBuilderPool::local().Acquire();
+            *sb << "value: " << value;
+
+         pool keeps up to MAX_POOLED builders, builders which grew larger
+         than MAX_RETAINED elements are freed instead of being kept, as well
+         as builders which gave away their buffer with MoveToString()
+
+         hits() and misses() count Acquire() calls served from the pool and
+         ones which had to create new builder
+
+         pool isn't thread safe, local() returns separate pool for every
+         thread, lease must be released on the thread which acquired it
+    */
+
+    template <typename T, typename N = StringExcludeNull>
+    class StringBuilderPoolBase
+    {
+    public:
+        enum
+        {
+            MAX_POOLED   = 16,
+            MAX_RETAINED = 1024 * 1024,
+            INITIAL_SIZE = 1024
+        };
+
+        using Builder = DynamicStringBuilderBase<T, N>;
+
+        class Lease
+        {
+        public:
+            Lease(Lease &&other) noexcept :
+                p_pool(other.p_pool),
+                p_builder(other.p_builder)
+            {
+                other.p_builder = nullptr;
+            }
+
+            Lease(const Lease &) = delete;
+            Lease &operator=(const Lease &) = delete;
+
+            ~Lease()
+            {
+                if (p_builder) {
+                    p_pool.Release(p_builder);
+                }
+            }
+
+            Builder &builder() const { return *p_builder; }
+
+            Builder &operator*() const { return *p_builder; }
+            Builder *operator->() const { return p_builder; }
+
+        private:
+            friend class StringBuilderPoolBase<T, N>;
+
+            Lease(StringBuilderPoolBase<T, N> &pool, Builder *builder) noexcept :
+                p_pool(pool),
+                p_builder(builder)
+            {}
+
+        private:
+            StringBuilderPoolBase<T, N> &p_pool;
+            Builder                     *p_builder;
+        };
+
+    public:
+        StringBuilderPoolBase() noexcept :
+            p_count(0),
+            p_hits(0),
+            p_misses(0)
+        {}
+
+        StringBuilderPoolBase(const StringBuilderPoolBase<T, N> &) = delete;
+        StringBuilderPoolBase<T, N> &operator=(const StringBuilderPoolBase<T, N> &) = delete;
+
+        ~StringBuilderPoolBase()
+        {
+            for (auto n = size_t(0); n < p_count; ++n) {
+                delete p_builders[n];
+            }
+        }
+
+        // pool of the calling thread
+        static StringBuilderPoolBase<T, N> &local()
+        {
+            static thread_local StringBuilderPoolBase<T, N> pool;
+            return pool;
+        }
+
+        Lease Acquire()
+        {
+            if (p_count == 0) {
+                ++p_misses;
+                return Lease(*this, new Builder(INITIAL_SIZE));
+            }
+
+            ++p_hits;
+
+            auto builder = p_builders[--p_count];
+            builder->Clear();
+            builder->width(unsigned(-1));
+            builder->precision(unsigned(-1));
+
+            return Lease(*this, builder);
+        }
+
+        size_t pooled() const { return p_count; }
+        size_t hits() const { return p_hits; }
+        size_t misses() const { return p_misses; }
+
+    private:
+        void Release(Builder *builder)
+        {
+            auto capacity = builder->capacity();
+            if (p_count == MAX_POOLED || capacity == 0 || capacity > MAX_RETAINED) {
+                delete builder;
+                return;
+            }
+
+            p_builders[p_count++] = builder;
+        }
+
+    private:
+        Builder *p_builders[MAX_POOLED];
+        size_t   p_count;
+        size_t   p_hits;
+        size_t   p_misses;
+    };
+
+    using StringBuilderPool = StringBuilderPoolBase<char>;
+    using StringBuilderPoolW = StringBuilderPoolBase<wchar_t>;
+    using StringBuilderPool32 = StringBuilderPoolBase<char32_t>;
+    using StringBuilderPoolNT = StringBuilderPoolBase<char, StringIncludeNull>;
+}
@@ -209,7 +209,7 @@ namespace c_common
                 exp = -exp;
             }
 
-            resultval = pow(result, exp);
+            resultval *= pow(10.0, exp);
         }
 
         if (neg) {
@@ -100,6 +100,10 @@ namespace c_util
 
     UF T sqr(T value);
 
+    // scramble hash value, so every bit of result depends on all bits of
+    // the source, useful to get bucket index from low bits of weak hash
+    inline size_t hashmix(size_t hash);
+
 
     /*
      -------------------------------------------------------------------------------
@@ -513,6 +517,29 @@ namespace c_util
         return value * value;
     }
 
+    // hashmix() constants for size_t of given size, selected by template so
+    // 64 bit constant and shift aren't compiled for 32 bit size_t
+    template <size_t size>
+    struct hashmix_constants
+    {
+        static constexpr size_t multiplier = 0x9E3779B9u;
+        static constexpr unsigned shift = 16;
+    };
+
+    template <>
+    struct hashmix_constants<8>
+    {
+        static constexpr unsigned long long multiplier = 0x9E3779B97F4A7C15ull;
+        static constexpr unsigned shift = 32;
+    };
+
+    inline size_t hashmix(size_t hash)
+    {
+        using constants = hashmix_constants<sizeof(size_t)>;
+        hash *= size_t(constants::multiplier);
+        return hash ^ (hash >> constants::shift);
+    }
+
 
     // pointT<T> IMPLEMENTATION
 